@@ -0,0 +1,21 @@
+#ifndef F_R_I_D_A_Y_BENCHMARKS_H
+#define F_R_I_D_A_Y_BENCHMARKS_H
+
+#include "stdbool.h"
+
+/**
+ * @file benchmarks.h
+ * @brief Contains the 'bench' command, which runs the built in micro benchmarks.
+ */
+
+///The label for the bench command.
+#define CMD_BENCH_LABEL "bench"
+
+/**
+ * @brief The bench command, used to run one or all benchmarks. Without a name, the benchmarks are listed.
+ * @param comm the command string.
+ * @return true if the command was handled, false if not.
+ */
+bool cmd_bench(const char *comm);
+
+#endif //F_R_I_D_A_Y_BENCHMARKS_H
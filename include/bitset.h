@@ -0,0 +1,162 @@
+#ifndef F_R_I_D_A_Y_BITSET_H
+#define F_R_I_D_A_Y_BITSET_H
+
+#include "stdbool.h"
+
+/**
+ * @file bitset.h
+ * @brief A fixed size set of bits stored in 32-bit words. Scans skip whole words at a time and use
+ * the processor's bit scan instructions to find the bit within a word.
+ */
+
+///The amount of bits in a single bitset word.
+#define BITSET_WORD_BITS 32
+
+///The amount of words needed to store the given amount of bits.
+#define BITSET_WORDS(bits) (((bits) + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS)
+
+/**
+ * @brief Statically initializes a bitset over the given word array.
+ * @param word_array the words, an array of BITSET_WORDS(bit_count) unsigned ints.
+ * @param bit_count the amount of bits.
+ */
+#define BITSET_INIT(word_array, bit_count) {.words = (word_array), .bits = (bit_count)}
+
+///The bitset structure. The memory for the words is owned by the user.
+typedef struct {
+    ///The words holding the bits, bit i is bit (i % 32) of word (i / 32).
+    unsigned int *words;
+    ///The amount of bits in the set.
+    int bits;
+} bitset_t;
+
+/**
+ * @brief Finds the index of the lowest set bit in the word. (bsf)
+ * @param word the word, which MUST NOT be 0.
+ * @return the index of the lowest set bit.
+ */
+static inline int bit_scan_forward(unsigned int word)
+{
+    int index;
+    __asm__ ("bsf %1, %0" : "=r" (index) : "rm" (word) : "cc");
+    return index;
+}
+
+/**
+ * @brief Finds the index of the highest set bit in the word. (bsr)
+ * @param word the word, which MUST NOT be 0.
+ * @return the index of the highest set bit.
+ */
+static inline int bit_scan_reverse(unsigned int word)
+{
+    int index;
+    __asm__ ("bsr %1, %0" : "=r" (index) : "rm" (word) : "cc");
+    return index;
+}
+
+/**
+ * @brief Counts the set bits in the word.
+ * @param word the word.
+ * @return the amount of set bits.
+ */
+int popcount(unsigned int word);
+
+/**
+ * @brief Initializes the bitset over the given words and clears every bit.
+ * @param set the bitset.
+ * @param words the words, an array of at least BITSET_WORDS(bits) unsigned ints.
+ * @param bits the amount of bits.
+ */
+void bitset_init(bitset_t *set, unsigned int *words, int bits);
+
+/**
+ * @brief Sets the bit.
+ * @param set the bitset.
+ * @param bit the index of the bit.
+ */
+void bitset_set(bitset_t *set, int bit);
+
+/**
+ * @brief Clears the bit.
+ * @param set the bitset.
+ * @param bit the index of the bit.
+ */
+void bitset_clear(bitset_t *set, int bit);
+
+/**
+ * @brief Flips the bit.
+ * @param set the bitset.
+ * @param bit the index of the bit.
+ */
+void bitset_toggle(bitset_t *set, int bit);
+
+/**
+ * @brief Checks the bit.
+ * @param set the bitset.
+ * @param bit the index of the bit.
+ * @return true if it's set, false if it's clear or out of range.
+ */
+bool bitset_test(const bitset_t *set, int bit);
+
+/**
+ * @brief Sets or clears the bit.
+ * @param set the bitset.
+ * @param bit the index of the bit.
+ * @param value true to set the bit, false to clear it.
+ */
+void bitset_assign(bitset_t *set, int bit, bool value);
+
+/**
+ * @brief Sets every bit in the range.
+ * @param set the bitset.
+ * @param start the first bit.
+ * @param count the amount of bits.
+ */
+void bitset_set_range(bitset_t *set, int start, int count);
+
+/**
+ * @brief Clears every bit in the range.
+ * @param set the bitset.
+ * @param start the first bit.
+ * @param count the amount of bits.
+ */
+void bitset_clear_range(bitset_t *set, int start, int count);
+
+/**
+ * @brief Sets or clears every bit in the set.
+ * @param set the bitset.
+ * @param value true to set every bit, false to clear them.
+ */
+void bitset_fill(bitset_t *set, bool value);
+
+/**
+ * @brief Finds the first set bit at or after the given index.
+ * @param set the bitset.
+ * @param from the index to start at.
+ * @return the index of the bit, or -1 if there is none.
+ */
+int bitset_find_first_set(const bitset_t *set, int from);
+
+/**
+ * @brief Finds the first clear bit at or after the given index.
+ * @param set the bitset.
+ * @param from the index to start at.
+ * @return the index of the bit, or -1 if there is none.
+ */
+int bitset_find_first_zero(const bitset_t *set, int from);
+
+/**
+ * @brief Finds the last set bit in the set.
+ * @param set the bitset.
+ * @return the index of the bit, or -1 if there is none.
+ */
+int bitset_find_last_set(const bitset_t *set);
+
+/**
+ * @brief Counts the set bits in the set.
+ * @param set the bitset.
+ * @return the amount of set bits.
+ */
+int bitset_count(const bitset_t *set);
+
+#endif //F_R_I_D_A_Y_BITSET_H
@@ -0,0 +1,128 @@
+#ifndef F_R_I_D_A_Y_DEQUE_H
+#define F_R_I_D_A_Y_DEQUE_H
+
+#include "stdbool.h"
+#include "stddef.h"
+
+/**
+ * @file deque.h
+ * @brief A fixed capacity ring buffer deque. The capacity is a power of two so indices wrap with a mask,
+ * and no memory is allocated after initialization.
+ */
+
+///The structure holding the deque's data.
+typedef struct {
+    ///The ring of elements.
+    void *data;
+    ///The size of a single element, in bytes.
+    size_t elem_size;
+    ///The amount of elements the ring holds, a power of two.
+    unsigned int capacity;
+    ///The index of the first element in the ring.
+    unsigned int head;
+    ///The amount of elements in the deque.
+    unsigned int size;
+    ///If pushing onto a full deque should drop the element at the opposite end.
+    bool overwrite;
+    ///If the ring was allocated by the deque, and should be freed with it.
+    bool owns_data;
+} deque_t;
+
+/**
+ * @brief Initializes the deque, allocating its ring. You should call @code deque_destroy(deque) when finished with it.
+ *
+ * @param deque the deque.
+ * @param elem_size the size of each element.
+ * @param capacity the minimum capacity, rounded up to a power of two.
+ * @param overwrite true if pushing onto a full deque should drop the element at the opposite end, false to reject the push.
+ * @return true if successful, false if the heap is full.
+ */
+bool deque_init(deque_t *deque, size_t elem_size, unsigned int capacity, bool overwrite);
+
+/**
+ * @brief Initializes the deque over the given memory.
+ *
+ * @param deque the deque.
+ * @param buffer the memory to use, large enough for capacity elements.
+ * @param elem_size the size of each element.
+ * @param capacity the capacity, which MUST be a power of two.
+ * @param overwrite true if pushing onto a full deque should drop the element at the opposite end, false to reject the push.
+ */
+void deque_init_buffer(deque_t *deque, void *buffer, size_t elem_size, unsigned int capacity, bool overwrite);
+
+/**
+ * @brief Frees the ring if the deque allocated it.
+ *
+ * @param deque the deque.
+ */
+void deque_destroy(deque_t *deque);
+
+/**
+ * @brief Checks if the deque is empty.
+ *
+ * @param deque the deque.
+ * @return true if there are no elements.
+ */
+bool deque_empty(const deque_t *deque);
+
+/**
+ * @brief Checks if the deque is full.
+ *
+ * @param deque the deque.
+ * @return true if the deque is at capacity.
+ */
+bool deque_full(const deque_t *deque);
+
+/**
+ * @brief Copies the element onto the back of the deque.
+ *
+ * @param deque the deque.
+ * @param elem a pointer to the element.
+ * @return true if it was added, false if the deque was full and not overwriting.
+ */
+bool deque_push_back(deque_t *deque, const void *elem);
+
+/**
+ * @brief Copies the element onto the front of the deque.
+ *
+ * @param deque the deque.
+ * @param elem a pointer to the element.
+ * @return true if it was added, false if the deque was full and not overwriting.
+ */
+bool deque_push_front(deque_t *deque, const void *elem);
+
+/**
+ * @brief Removes the first element of the deque.
+ *
+ * @param deque the deque.
+ * @param out where to copy the removed element, may be NULL.
+ * @return true if an element was removed, false if the deque was empty.
+ */
+bool deque_pop_front(deque_t *deque, void *out);
+
+/**
+ * @brief Removes the last element of the deque.
+ *
+ * @param deque the deque.
+ * @param out where to copy the removed element, may be NULL.
+ * @return true if an element was removed, false if the deque was empty.
+ */
+bool deque_pop_back(deque_t *deque, void *out);
+
+/**
+ * @brief Gets a pointer to the element at the given index, counted from the front.
+ *
+ * @param deque the deque.
+ * @param index the index.
+ * @return the element, or NULL if the index is out of bounds.
+ */
+void *deque_at(const deque_t *deque, unsigned int index);
+
+/**
+ * @brief Removes all elements.
+ *
+ * @param deque the deque.
+ */
+void deque_clear(deque_t *deque);
+
+#endif //F_R_I_D_A_Y_DEQUE_H
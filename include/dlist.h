@@ -0,0 +1,176 @@
+#ifndef F_R_I_D_A_Y_DLIST_H
+#define F_R_I_D_A_Y_DLIST_H
+
+#include "stdbool.h"
+#include "stddef.h"
+
+/**
+ * @file dlist.h
+ * @brief An intrusive, circular doubly linked list. The link node is embedded inside the structure
+ * being stored, so adding and removing never allocates and unlinking a known node is O(1).
+ */
+
+#ifndef container_of
+/**
+ * @brief Gets a pointer to the structure containing the given member.
+ * @param ptr the pointer to the member.
+ * @param type the type of the containing structure.
+ * @param member the name of the member within the structure.
+ */
+#define container_of(ptr, type, member) ((type *) ((char *) (ptr) - offsetof(type, member)))
+#endif
+
+/**
+ * @brief Gets the structure containing the given list node, or NULL if the node is NULL.
+ * @param node the list node.
+ * @param type the type of the containing structure.
+ * @param member the name of the dlist_node member within the structure.
+ */
+#define dlist_entry(node, type, member) ((node) == NULL ? NULL : container_of(node, type, member))
+
+/**
+ * @brief Iterates over every node in the list, front to back. The current node must not be removed
+ * while iterating, use dlist_for_each_safe for that.
+ * @param list the list.
+ * @param iter the name of the node variable.
+ */
+#define dlist_for_each(list, iter) \
+    for (dlist_node *iter = (list)->head.next; iter != &(list)->head; iter = iter->next)
+
+/**
+ * @brief Iterates over every node in the list, front to back. The current node may be removed.
+ * @param list the list.
+ * @param iter the name of the node variable.
+ * @param tmp the name of the variable holding the following node.
+ */
+#define dlist_for_each_safe(list, iter, tmp) \
+    for (dlist_node *iter = (list)->head.next, *tmp = iter->next; iter != &(list)->head; iter = tmp, tmp = iter->next)
+
+///The link embedded into every structure stored in a dlist.
+typedef struct dlist_node_
+{
+    ///The previous node, or the list head.
+    struct dlist_node_ *prev;
+    ///The next node, or the list head.
+    struct dlist_node_ *next;
+} dlist_node;
+
+///The intrusive list itself. The head is a sentinel, so an empty list points to itself.
+typedef struct
+{
+    ///The sentinel node.
+    dlist_node head;
+    ///The amount of nodes in the list.
+    int size;
+} dlist;
+
+/**
+ * @brief Initializes the list as empty.
+ * @param list the list.
+ */
+void dlist_init(dlist *list);
+
+/**
+ * @brief Initializes the node as not belonging to any list.
+ * @param node the node.
+ */
+void dlist_node_init(dlist_node *node);
+
+/**
+ * @brief Checks if the node is currently in a list.
+ * @param node the node, which must have been initialized or zeroed.
+ * @return true if it's linked, false if not.
+ */
+bool dlist_linked(const dlist_node *node);
+
+/**
+ * @brief Checks if the list is empty.
+ * @param list the list.
+ * @return true if the list has no nodes.
+ */
+bool dlist_empty(const dlist *list);
+
+/**
+ * @brief Adds the node to the front of the list.
+ * @param list the list.
+ * @param node the node, which must not be in a list.
+ */
+void dlist_push_front(dlist *list, dlist_node *node);
+
+/**
+ * @brief Adds the node to the back of the list.
+ * @param list the list.
+ * @param node the node, which must not be in a list.
+ */
+void dlist_push_back(dlist *list, dlist_node *node);
+
+/**
+ * @brief Adds the node directly before the given position.
+ * @param list the list.
+ * @param pos the node to insert before, or the list head to insert at the back.
+ * @param node the node, which must not be in a list.
+ */
+void dlist_insert_before(dlist *list, dlist_node *pos, dlist_node *node);
+
+/**
+ * @brief Adds the node after every node that compares less than or equal to it, so nodes that
+ * compare equal keep their insertion order. The search starts from the back, as queues mostly
+ * receive nodes that belong there.
+ * @param list the list, which must already be sorted.
+ * @param node the node, which must not be in a list.
+ * @param cmp the comparison function.
+ */
+void dlist_insert_sorted(dlist *list, dlist_node *node, int (*cmp)(dlist_node *, dlist_node *));
+
+/**
+ * @brief Unlinks the node from the list. Does nothing if the node isn't linked.
+ * @param list the list the node is in.
+ * @param node the node.
+ */
+void dlist_remove(dlist *list, dlist_node *node);
+
+/**
+ * @brief Gets the first node in the list.
+ * @param list the list.
+ * @return the first node, or NULL if the list is empty.
+ */
+dlist_node *dlist_front(const dlist *list);
+
+/**
+ * @brief Gets the last node in the list.
+ * @param list the list.
+ * @return the last node, or NULL if the list is empty.
+ */
+dlist_node *dlist_back(const dlist *list);
+
+/**
+ * @brief Gets the node after the given one.
+ * @param list the list.
+ * @param node the node.
+ * @return the next node, or NULL if the node was the last.
+ */
+dlist_node *dlist_next(const dlist *list, const dlist_node *node);
+
+/**
+ * @brief Gets the node before the given one.
+ * @param list the list.
+ * @param node the node.
+ * @return the previous node, or NULL if the node was the first.
+ */
+dlist_node *dlist_prev(const dlist *list, const dlist_node *node);
+
+/**
+ * @brief Removes and returns the first node in the list.
+ * @param list the list.
+ * @return the removed node, or NULL if the list was empty.
+ */
+dlist_node *dlist_pop_front(dlist *list);
+
+/**
+ * @brief Removes and returns the last node in the list.
+ * @param list the list.
+ * @return the removed node, or NULL if the list was empty.
+ */
+dlist_node *dlist_pop_back(dlist *list);
+
+#endif //F_R_I_D_A_Y_DLIST_H
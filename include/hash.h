@@ -0,0 +1,87 @@
+#ifndef F_R_I_D_A_Y_HASH_H
+#define F_R_I_D_A_Y_HASH_H
+
+#include "stdbool.h"
+#include "stddef.h"
+
+/**
+ * @file hash.h
+ * @brief Hash functions for strings, integers and coordinates, along with adapters for @code hash_map_t.
+ */
+
+/**
+ * @brief Hashes the given bytes with 32-bit FNV-1a.
+ * @param data the bytes to hash.
+ * @param len the amount of bytes.
+ * @return the hash.
+ */
+unsigned int hash_bytes(const void *data, size_t len);
+
+/**
+ * @brief Hashes the given null terminated string with 32-bit FNV-1a.
+ * @param str the string.
+ * @return the hash.
+ */
+unsigned int hash_string(const char *str);
+
+/**
+ * @brief Hashes the given string ignoring case, so it agrees with @code strcicmp.
+ * @param str the string.
+ * @return the hash.
+ */
+unsigned int hash_string_ci(const char *str);
+
+/**
+ * @brief Mixes the bits of an integer so that every input bit affects every output bit.
+ * @param x the integer.
+ * @return the hash.
+ */
+unsigned int hash_int(unsigned int x);
+
+/**
+ * @brief Combines a hash with another value, order matters.
+ * @param seed the hash so far.
+ * @param value the value to mix in.
+ * @return the combined hash.
+ */
+unsigned int hash_combine(unsigned int seed, unsigned int value);
+
+/**
+ * @brief Hashes a 2D coordinate. Unlike a sum of the components, (x, y) and (y, x) hash differently.
+ * @param x the x component.
+ * @param y the y component.
+ * @return the hash.
+ */
+unsigned int hash_coordinate(int x, int y);
+
+/**
+ * @brief A @code hash_map_t hash function for string keys.
+ * @param str the string.
+ * @return the hash.
+ */
+int str_hash_func(void *str);
+
+/**
+ * @brief A @code hash_map_t hash function for string keys that ignores case.
+ * @param str the string.
+ * @return the hash.
+ */
+int str_ci_hash_func(void *str);
+
+/**
+ * @brief A @code hash_map_t equality function for string keys.
+ * @param str1 the first string.
+ * @param str2 the second string.
+ * @return true if the strings are equal.
+ */
+bool str_equals(void *str1, void *str2);
+
+/**
+ * @brief A @code hash_map_t equality function for string keys that ignores case.
+ * @param str1 the first string.
+ * @param str2 the second string.
+ * @return true if the strings are equal ignoring case.
+ */
+bool str_ci_equals(void *str1, void *str2);
+
+#endif //F_R_I_D_A_Y_HASH_H
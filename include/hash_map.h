@@ -10,35 +10,47 @@
 /**
  * @file hash_map.h
  * @brief The header file for the hash map structure.
+ * The map is a flat, open addressed table using Robin Hood linear probing. Entries are stored inline
+ * and removal shifts the following entries back, so no tombstones are ever left behind.
  */
 
-///The structure definition for holding a node in a hash map.
+///The structure definition for holding a node in a hash map. Nodes are stored inline in the table.
 typedef struct {
-    ///The hash m
+    ///The key being held in this node.
     void *key;
     ///The value being held in this node.
     void *value;
-    ///The hash code for the value being held.
-    int hash_code;
+    ///The mixed hash code for the key, 0 if this node is empty.
+    unsigned int hash_code;
 } hash_map_node_t;
 
 ///The definition for the structure holding the hash map data.
 typedef struct {
     ///The size of the hash map.
     int size;
-    ///The total amount of elements + tombstones in the map.
-    int contamination;
-    ///The capacity of the hash map.
+    ///The capacity of the hash map, always a power of two.
     int capacity;
     ///The function to use for equality checking for given values.
     bool (*equality_func)(void *value1, void *value2);
     ///The hash function to use for the values in this map.
     int (*hash_func)(void *value);
 
-    ///The values we're holding in this map.
-    hash_map_node_t **values;
+    ///The nodes we're holding in this map.
+    hash_map_node_t *values;
 } hash_map_t;
 
+///An iterator over the entries of a hash map.
+typedef struct {
+    ///The map being iterated.
+    hash_map_t *map;
+    ///The index of the current node.
+    int index;
+    ///The key of the current node.
+    void *key;
+    ///The value of the current node.
+    void *value;
+} hash_map_iter_t;
+
 /**
  * @brief Creates a new hash map with the given equality and hash functions. These CANNOT be NULL!
  *
@@ -48,11 +60,30 @@ typedef struct {
  */
 hash_map_t *new_map(bool (*equality_func)(void *value1, void *value2), int (*hash_func)(void *value));
 
+/**
+ * @brief Frees the map and its table.
+ *
+ * @param map the map to destroy.
+ * @param free_keys if we should free the keys associated with the map.
+ * @param free_values if we should free the values associated with the map.
+ */
+void destroy_map(hash_map_t *map, bool free_keys, bool free_values);
+
+/**
+ * @brief Grows the map so it can hold the given amount of entries without resizing.
+ *
+ * @param map the map.
+ * @param count the amount of entries.
+ * @return true if the map can now hold that many entries, false if the heap is full.
+ */
+bool map_reserve(hash_map_t *map, int count);
+
 /**
  * @brief Puts the given item into the map, returning the old item if it is contained.
  *
  * @param map the map to put it into.
- * @param item the item to place into this map.
+ * @param key the key to store the value under.
+ * @param value the value to place into this map.
  * @return the old value or NULL.
  */
 void *put(hash_map_t *map, void *key, void *value);
@@ -66,6 +97,15 @@ void *put(hash_map_t *map, void *key, void *value);
  */
 void *get(hash_map_t *map, void *key);
 
+/**
+ * @brief Removes the given key from the map.
+ *
+ * @param map the map.
+ * @param key the key to remove.
+ * @return the value that was stored under the key, or NULL.
+ */
+void *remove_key(hash_map_t *map, void *key);
+
 /**
  * @brief Checks if the map contains the given key.
  *
@@ -76,13 +116,30 @@ void *get(hash_map_t *map, void *key);
 bool contains_key(hash_map_t *map, void *key);
 
 /**
- * Clears the map, freeing all nodes (NOT THE ITEMS INSIDE THE NODES).
+ * @brief Creates an iterator positioned before the first entry of the map.
+ * The map must not be modified while the iterator is in use.
+ *
+ * @param map the map.
+ * @return the iterator.
+ */
+hash_map_iter_t map_iterator(hash_map_t *map);
+
+/**
+ * @brief Moves the iterator to the next entry, filling in its key and value.
+ *
+ * @param iter the iterator.
+ * @return true if there was another entry, false if iteration is finished.
+ */
+bool map_next(hash_map_iter_t *iter);
+
+/**
+ * Clears the map (NOT THE ITEMS INSIDE THE NODES).
  * @param map the map to clear.
  */
 void clear(hash_map_t *map);
 
 /**
- * Clears the map, freeing all nodes and the items they're holding.
+ * Clears the map, freeing the items the nodes are holding.
  *
  * @param map the map to clear.
  * @param free_keys if we should free the keys associated with the map.
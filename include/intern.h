@@ -0,0 +1,55 @@
+#ifndef F_R_I_D_A_Y_INTERN_H
+#define F_R_I_D_A_Y_INTERN_H
+
+#include "stdbool.h"
+
+/**
+ * @file intern.h
+ * @brief The global symbol table. Interning a string returns the one canonical copy of it, so two interned
+ * strings are equal exactly when their pointers are. Case insensitive symbols live in their own namespace,
+ * where "RED" and "red" intern to the same symbol. Symbols are never freed, so only strings that live
+ * forever, like literals, can be interned.
+ */
+
+///The maximum amount of symbols that can be interned at once.
+#define INTERN_MAX_SYMBOLS 384
+
+///An interned string. Symbols can be compared with == and printed like any other string.
+typedef const char *symbol_t;
+
+/**
+ * @brief Interns a string that lives forever, like a literal. The string is used as the symbol without
+ * being copied, unless it was already interned.
+ * @param str the string.
+ * @return the symbol, or NULL if the table is full.
+ */
+symbol_t intern_static(const char *str);
+
+/**
+ * @brief Interns a string that lives forever, ignoring case.
+ * @param str the string.
+ * @return the symbol, which keeps the spelling it was first interned with, or NULL if the table is full.
+ */
+symbol_t intern_static_ci(const char *str);
+
+/**
+ * @brief Finds the symbol for the string without interning it.
+ * @param str the string.
+ * @return the symbol, or NULL if it isn't interned, in which case it equals no symbol.
+ */
+symbol_t find_symbol(const char *str);
+
+/**
+ * @brief Finds the case insensitive symbol for the string without interning it.
+ * @param str the string.
+ * @return the symbol, or NULL if it isn't interned.
+ */
+symbol_t find_symbol_ci(const char *str);
+
+/**
+ * @brief Gets the amount of symbols currently interned.
+ * @return the amount of symbols.
+ */
+int symbol_count(void);
+
+#endif //F_R_I_D_A_Y_INTERN_H
@@ -161,6 +161,15 @@ void
 void
 set_sort_func(linked_list *list, int sort_func(void *, void *));
 
+/**
+ * @brief Sorts the list with a stable, in place merge sort. O(n log n) with no allocation.
+ * Use this instead of a sort function when many items are added at once.
+ * @param list the list to sort.
+ * @param cmp the comparison function, or NULL to use the list's sort function.
+ */
+void
+ll_sort(linked_list *list, int (*cmp)(void *, void *));
+
 /**
  * Applies the given function to each item within the linked list.
  * @param list the list to apply to.
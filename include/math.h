@@ -6,6 +6,7 @@
 #define F_R_I_D_A_Y_MATH_H
 
 #include "stdbool.h"
+#include "stddef.h"
 
 /**
  * @file math.h
@@ -35,22 +36,79 @@ unsigned int ui_realmod(int x, int mod);
 */
 double pow(double a, double b);
 
+///The state of a single random number stream. (xoshiro128**)
+typedef struct {
+    ///The 128 bits of generator state.
+    unsigned int s[4];
+} rand_state_t;
+
 /**
- * @brief Gets the current seed for the random.
- *
- * @return the seed.
- * @authors Andrew Bowie
+ * @brief Seeds the given random stream.
+ * @param state the stream.
+ * @param seed the seed.
+ */
+void rand_seed(rand_state_t *state, unsigned long long seed);
+
+/**
+ * @brief Seeds the given random stream as one of many independent streams sharing a seed.
+ * The same seed and stream id always produce the same sequence.
+ * @param state the stream.
+ * @param seed the shared seed.
+ * @param stream the id of this stream.
+ */
+void rand_stream(rand_state_t *state, unsigned long long seed, unsigned int stream);
+
+/**
+ * @brief Generates the next 32 random bits from the given stream.
+ * @param state the stream.
+ * @return the next random number.
+ */
+unsigned int rand_next(rand_state_t *state);
+
+/**
+ * @brief Generates the next random number in the range [0, limit) from the given stream.
+ * @param state the stream.
+ * @param limit the limit.
+ * @return the next random number.
+ */
+unsigned int rand_next_lim(rand_state_t *state, unsigned int limit);
+
+/**
+ * @brief Advances the stream by 2^64 numbers. Calling this repeatedly on a copy hands out
+ * sub-sequences that are guaranteed not to overlap.
+ * @param state the stream.
+ */
+void rand_jump(rand_state_t *state);
+
+/**
+ * @brief Fills the buffer with random numbers from the given stream.
+ * @param state the stream.
+ * @param buffer the buffer to fill.
+ * @param count the amount of numbers to generate.
+ */
+void rand_fill(rand_state_t *state, unsigned int *buffer, size_t count);
+
+/**
+ * @brief Sets the stream used by the next_random functions. Called by the dispatcher so each
+ * process draws from its own stream.
+ * @param state the stream, or NULL to use the kernel's stream.
+ */
+void set_rand_state(rand_state_t *state);
+
+/**
+ * @brief Gets the stream currently used by the next_random functions.
+ * @return the active stream.
  */
-unsigned long long get_seed(void);
+rand_state_t *get_rand_state(void);
 
 /**
- * @brief Seeds the random number generator.
+ * @brief Seeds the active random stream.
  * @param seed the seed.
  */
 void s_rand(unsigned long long seed);
 
 /**
- * @brief Returns the next random 30 bits from the LCRNG.
+ * @brief Returns the next random 32 bits from the active stream.
  * @return the next random number.
  */
 unsigned int next_random(void);
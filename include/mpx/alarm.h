@@ -7,8 +7,9 @@
  */
 
 /**
- * @brief Creates a new pcb that will display message at or after given time
- * @param time_array the time to display message
+ * @brief Queues an alarm that will display message at or after given time. All alarms are printed by a single
+ * alarm service process, which is started with the first alarm.
+ * @param time_array the time to display message, in the clock's time zone
  * @param message message to display
  * @return true if the alarm was created, false if it failed.
  * @author Kolby Eisenhauer, Andrew Bowie
@@ -0,0 +1,19 @@
+#ifndef MPX_CPU_H
+#define MPX_CPU_H
+
+/**
+ @file mpx/cpu.h
+ @brief Kernel macros for reading processor state
+*/
+
+/**
+ Read the processor's time stamp counter
+ @return The amount of cycles since the processor was reset
+*/
+#define rdtsc() ({							\
+      unsigned int lo, hi;						\
+      __asm__ volatile ("rdtsc" : "=a" (lo), "=d" (hi));		\
+      ((unsigned long long) hi << 32) | lo;				\
+    })
+
+#endif
@@ -12,6 +12,38 @@
 /** Enable interrupts */
 #define cli() __asm__ volatile ("cli")
 
+/** Halt until the next interrupt. Interrupts must be enabled, or this never returns. */
+#define hlt() __asm__ volatile ("hlt" ::: "memory")
+
+/**
+ Check if interrupts are enabled
+ @return true if the interrupt flag is set
+*/
+#define interrupts_enabled() ({						\
+      unsigned int eflags;						\
+      __asm__ volatile ("pushf\n\tpop %0" : "=r" (eflags));		\
+      (eflags & 0x200) != 0;						\
+    })
+
+/**
+ Disable interrupts, remembering whether they were enabled. Unlike a cli/sti
+ pair, this can be nested and used from code that already runs with
+ interrupts disabled, like sys_call.
+ @return The flags register from before interrupts were disabled
+*/
+#define irq_save() ({							\
+      unsigned int flags;						\
+      __asm__ volatile ("pushf\n\tpop %0\n\tcli" : "=r" (flags) :: "memory");	\
+      flags;								\
+    })
+
+/**
+ Restore the interrupt state saved by irq_save()
+ @param flags The flags register returned by irq_save()
+*/
+#define irq_restore(flags)						\
+	__asm__ volatile ("push %0\n\tpopf" :: "r" (flags) : "memory", "cc")
+
 /**
  Installs the initial interrupt handlers for the first 32 IRQ lines. Most do a
  panic for now.
@@ -1,5 +1,9 @@
 #include "stdbool.h"
 #include "stddef.h"
+#include "math.h"
+#include "dlist.h"
+#include "pqueue.h"
+#include "sys_req.h"
 #ifndef MPX_PCB_H
 #define MPX_PCB_H
 
@@ -10,8 +14,38 @@
 
 ///The maximum length of a PCB's name.
 #define PCB_MAX_NAME_LEN 8
-///The initial size of a PCB's stack.
+///The amount of priority levels, priorities range from 0 to PCB_PRIORITY_LEVELS - 1.
+#define PCB_PRIORITY_LEVELS 10
+///The default size of a PCB's stack, used when no size is given.
 #define PCB_STACK_SIZE 2048
+///The smallest stack a PCB may have, enough for its context and the interrupt handlers that run on top of it.
+#define PCB_MIN_STACK_SIZE 512
+///The stack size for small processes, like the idle process and the R3 test processes.
+#define PCB_SMALL_STACK_SIZE 1024
+///The stack size for processes with deep call chains and large buffers, like comhand running the games.
+#define PCB_LARGE_STACK_SIZE 8192
+///The byte stacks are filled with before use, so the deepest point they reached can be found later.
+#define PCB_STACK_FILL 0xA5
+///The most memory exited PCBs kept around for reuse may take up, in bytes.
+#define PCB_POOL_MAX_BYTES 8192
+///The amount of system request types counted for each PCB.
+#define PCB_SYSCALL_TYPES (SLEEP_UNTIL + 1)
+///The name of the idle process, which isn't counted as runnable.
+#define IDLE_PCB_NAME "idle"
+///The label for the top command.
+#define CMD_TOP_LABEL "top"
+///The label for the sched command.
+#define CMD_SCHED_LABEL "sched"
+///The share of the CPU real-time reservations may add up to, in thousandths. The rest is kept for the priority queues.
+#define RT_MAX_UTILIZATION 900
+
+///The policies used to pick the next process.
+enum sched_policy {
+    ///The highest priority ready process always runs first.
+    SCHED_STRICT = 0,
+    ///Processes waiting for long are boosted, and processes using up their quantum are decayed.
+    SCHED_FAIR = 1,
+};
 
 ///The clas of a PCB.
 enum pcb_class {
@@ -32,27 +66,103 @@ enum pcb_dispatch_state {
     SUSPENDED = 1,
 };
 
+///The CPU accounting kept for a PCB. Times are in TSC cycles.
+struct pcb_stats {
+    ///The cycles spent running.
+    unsigned long long run_cycles;
+    ///The cycles spent blocked.
+    unsigned long long blocked_cycles;
+    ///The TSC value the PCB was last dispatched at.
+    unsigned long long dispatched_at;
+    ///The TSC value the PCB blocked at, 0 while it isn't blocked.
+    unsigned long long blocked_at;
+    ///The run cycles at the previous top refresh.
+    unsigned long long top_cycles;
+    ///The amount of times the PCB was dispatched.
+    unsigned int dispatches;
+    ///The amount of times the PCB gave up the CPU itself.
+    unsigned int voluntary_switches;
+    ///The amount of times the PCB was preempted.
+    unsigned int involuntary_switches;
+    ///The amount of system requests made, by op code.
+    unsigned int syscalls[PCB_SYSCALL_TYPES];
+    ///The amount of bytes read from devices.
+    unsigned int bytes_read;
+    ///The amount of bytes written to devices.
+    unsigned int bytes_written;
+    ///The timer tick the PCB became ready at, only meaningful while waiting.
+    unsigned long long ready_tick;
+    ///Whether the PCB is waiting in a ready queue.
+    bool waiting;
+    ///The longest the PCB waited in a ready queue, in timer ticks.
+    unsigned int max_wait_ticks;
+    ///The total time the PCB waited in a ready queue, in timer ticks.
+    unsigned int total_wait_ticks;
+    ///The amount of waits in a ready queue that ended with a dispatch.
+    unsigned int waits;
+};
+
+/**
+ * @brief The real-time reservation of a PCB. Real-time PCBs run earliest deadline first, ahead of every priority.
+ * Each job is released with a deadline one period away and may run for the budget before that deadline, after
+ * which it's throttled until the deadline passes.
+ */
+struct pcb_rt {
+    ///The period, which is also the relative deadline of every job, in ticks. 0 if the PCB isn't real-time.
+    unsigned int period_ticks;
+    ///The run time reserved each period, in ticks.
+    unsigned int budget_ticks;
+    ///The share of the CPU reserved, in thousandths.
+    unsigned int utilization;
+    ///The run time the current job has left, in ticks.
+    unsigned int budget_left;
+    ///The absolute deadline of the current job, in ticks.
+    unsigned long long deadline;
+    ///Whether the current job already ran past its deadline.
+    bool late;
+    ///The amount of jobs released.
+    unsigned int jobs;
+    ///The amount of jobs that ran past their deadline.
+    unsigned int misses;
+    ///The amount of jobs throttled for using up their budget.
+    unsigned int throttles;
+};
+
 ///The definition of a process control block.
 struct pcb {
-    ///This exists as an extremely hacky way to use them in the linked list without allocating memory.
-    void *_next;
-    ///This exists as an extremely hacky way to use them in the linked list without allocating memory.
-    void *_item;
+    ///The link into the PCB queue.
+    dlist_node queue_node;
+    ///The index of the queue the PCB is linked into, only meaningful while queue_node is linked.
+    int queue_index;
+    ///The node in the timer's sleep queue, queued while the PCB sleeps.
+    pq_node sleep_node;
+    ///The timer tick the PCB wakes up at, only meaningful while it sleeps.
+    unsigned long long wake_tick;
 
-    ///The name of the PCB, max length of 8.
-    const char *name;
+    ///The name of the PCB, max length of 8, stored inline.
+    char name[PCB_MAX_NAME_LEN + 1];
     ///The process class type.
     enum pcb_class process_class;
     ///Integer priority of PCB, 0-9, lower = higher priority;
     int priority;
+    ///The priority the PCB is scheduled at. Equal to priority, unless fair scheduling aged or decayed it.
+    int effective_priority;
     ///The execution state of this PCB.
     enum pcb_exec_state exec_state;
     ///The dispatch state of this PCB.
     enum pcb_dispatch_state dispatch_state;
+    ///The random number stream owned by this PCB.
+    rand_state_t rand_state;
+    ///The CPU accounting for this PCB.
+    struct pcb_stats stats;
+    ///The real-time reservation of this PCB.
+    struct pcb_rt rt;
     ///A pointer to the next available byte in the stack.
     void *stack_ptr;
-    ///The stack itself.
-    unsigned char stack[PCB_STACK_SIZE];
+    ///The size of the stack, in bytes.
+    size_t stack_size;
+    ///The stack itself, allocated along with the PCB.
+    unsigned char stack[];
 };
 
 ///The context to save onto a PCB.
@@ -72,27 +182,143 @@ struct context {
 void setup_queue(void);
 
 /**
- * @brief Peeks the next available PCB, or returns NULL if it's empty.
+ * @brief Peeks the highest priority ready PCB, or returns NULL if none is ready. Runs in O(1).
  * @return the next PCB or NULL.
  */
 struct pcb *peek_next_pcb(void);
 
 /**
- * @brief Polls the next available PCB, or returns NULL if it's empty.
+ * @brief Gets the amount of processes that are ready or running, not counting the idle process.
+ * @return the amount of runnable processes.
+ */
+int runnable_pcb_count(void);
+
+/**
+ * @brief Starts or stops counting the PCB's blocked and waiting time, depending on its state. Called whenever
+ * the PCB changes state.
+ * @param pcb_ptr the PCB.
+ */
+void pcb_track_state(struct pcb *pcb_ptr);
+
+/**
+ * @brief Sets the scheduling policy. Going back to strict scheduling restores every PCB's own priority.
+ * @param policy the policy.
+ */
+void set_sched_policy(enum sched_policy policy);
+
+/**
+ * @brief Gets the scheduling policy.
+ * @return the policy.
+ */
+enum sched_policy get_sched_policy(void);
+
+/**
+ * @brief Makes the PCB real-time, reserving the budget every period, or makes it a normal PCB again. A PCB that
+ * only has a deadline declares it as the period. Admission control rejects reservations that would push the
+ * real-time share of the CPU above RT_MAX_UTILIZATION.
+ * @param pcb_ptr the PCB.
+ * @param period_ms the period in milliseconds, or 0 to stop being real-time.
+ * @param budget_ms the run time reserved each period in milliseconds, at most the period.
+ * @return true if the reservation was made, false if it was invalid or rejected.
+ */
+bool pcb_set_realtime(struct pcb *pcb_ptr, unsigned int period_ms, unsigned int budget_ms);
+
+/**
+ * @brief Checks if the PCB is real-time.
+ * @param pcb_ptr the PCB.
+ * @return true if it's scheduled earliest deadline first.
+ */
+bool pcb_is_realtime(const struct pcb *pcb_ptr);
+
+/**
+ * @brief Gets the share of the CPU reserved by real-time PCBs.
+ * @return the share, in thousandths.
+ */
+unsigned int get_rt_utilization(void);
+
+/**
+ * @brief Compares which of two PCBs should run first. Real-time PCBs come before all others, ordered by
+ * deadline, and the rest are ordered by effective priority.
+ * @param pcb_ptr1 the first PCB.
+ * @param pcb_ptr2 the second PCB.
+ * @return negative if the first should run first, positive if the second should, 0 if neither.
+ */
+int pcb_rank_cmp(const struct pcb *pcb_ptr1, const struct pcb *pcb_ptr2);
+
+/**
+ * @brief Called by the timer on every tick for the running PCB, charging the tick to its real-time budget.
+ * @param pcb_ptr the running PCB.
+ * @return true if the PCB is real-time and used up its budget, so it has to be throttled.
+ */
+bool charge_realtime(struct pcb *pcb_ptr);
+
+/**
+ * @brief Called by the timer on every tick. Under fair scheduling, PCBs that waited in a ready queue for a
+ * whole aging period are boosted one priority level.
+ */
+void age_ready_pcbs(void);
+
+/**
+ * @brief Called by the timer when the running PCB used up its quantum. Under fair scheduling, the PCB is
+ * decayed one priority level.
+ * @param pcb_ptr the running PCB.
+ */
+void decay_pcb(struct pcb *pcb_ptr);
+
+/**
+ * @brief The sched command, showing the scheduling policy and how long each process waited to run.
+ * 'sched strict' and 'sched fair' change the policy.
+ * @param comm the command string.
+ * @return true if it was handled, false if not.
+ */
+bool cmd_sched(const char *comm);
+
+/**
+ * @brief The top command, showing the processes sorted by their CPU usage, along with the load averages.
+ * The view is refreshed every second, 'top (n)' refreshes it n times.
+ * @param comm the command string.
+ * @return true if it was handled, false if not.
+ */
+bool cmd_top(const char *comm);
+
+/**
+ * @brief Polls the highest priority ready PCB, or returns NULL if none is ready. Runs in O(1).
  * @return the next PCB or NULL.
  */
 struct pcb *poll_next_pcb(void);
 
 /**
- * @brief Allocates memory for a PCB block.
+ * @brief Removes every PCB from every queue, without freeing them.
+ */
+void clear_pcb_queues(void);
+
+/**
+ * @brief Allocates memory for a PCB block, with its stack filled with PCB_STACK_FILL.
  *
- * @return A pointer to the allocated PCB.
+ * @param stack_size the size of the stack, 0 for PCB_STACK_SIZE. Rounded up to a multiple of 4.
+ * @return A pointer to the allocated PCB, or NULL if the size is below PCB_MIN_STACK_SIZE or the heap is full.
  * @authors Andrew Bowie, Kolby Eisenhauer
  */
-struct pcb *pcb_alloc(void);
+struct pcb *pcb_alloc(size_t stack_size);
+
+/**
+ * @brief Sets whether exited PCBs are kept in a pool to be reused by the next PCB with the same stack size.
+ * Turning the pool off frees every PCB in it.
+ * @param enabled whether to pool exited PCBs.
+ * @return whether the pool was enabled before.
+ */
+bool set_pcb_pool_enabled(bool enabled);
+
+/**
+ * @brief Gets the most stack the PCB has used, found from how much of the fill pattern was overwritten.
+ * @param pcb_ptr the PCB.
+ * @return the high-watermark, in bytes. Equal to the stack size if the stack may have overflowed.
+ */
+size_t pcb_stack_high_watermark(const struct pcb *pcb_ptr);
 
 /**
- * @brief Frees the memory associated with the given PCB block.
+ * @brief Frees the memory associated with the given PCB block. The PCB is kept in the pool instead if it
+ * has room, and is reused by the next PCB with the same stack size.
  *
  * @param pcb_ptr the pointer to the pcb.
  * @return 0 on success, non-zero on failure.
@@ -106,20 +332,22 @@ int pcb_free(struct pcb* pcb_ptr);
  * @param name the name of the PCB, cannot be longer than @code PCB_MAX_NAME_LEN chars.
  * @param class the class of the PCB.
  * @param priority the priority of the PCB.
- * @return the created PCB, or NULL on error.
+ * @param stack_size the size of the PCB's stack, 0 for PCB_STACK_SIZE.
+ * @return the created PCB, or NULL on error or if a PCB with the name already exists.
  * @authors Andrew Bowie
  */
-struct pcb *pcb_setup(const char *name, int class, int priority);
+struct pcb *pcb_setup(const char *name, int class, int priority, size_t stack_size);
 
 /**
-* @brief Inserts a PCB into appropriate queue, based on state and priority
+* @brief Inserts a PCB into appropriate queue, based on state and priority. Suspended PCBs go to the
+* suspended queue, blocked PCBs to the blocked queue and the rest to the back of their priority's ready queue.
 * @param pcb_ptr pointer to pcb
 * @authors Kolby Eisenhauers
 */
 void pcb_insert(struct pcb* pcb_ptr);
 
 /**
- * @brief Finds the PCB with the given name.
+ * @brief Finds the PCB with the given name, whether it's queued or running. Runs in O(1) using the name index.
  * @param name the name of the pCB
  * @return the pcb found, or NULL if not found.
  * @authors Jared Crowley
@@ -141,6 +369,10 @@ bool pcb_remove(struct pcb *pcb_ptr);
  * @param priority the priority of the process.
  * @param class the class of the process.
  * @param begin_ptr the pointer of the function to start.
+ * @param input the arguments to copy onto the stack, or NULL.
+ * @param input_len the length of the arguments.
+ * @param param_ptrs the amount of arguments at the start of the input that are pointers into it.
+ * @param stack_size the size of the process' stack, 0 for PCB_STACK_SIZE.
  * @return true if the PCB was successfully scheduled and started.
  * @authors Andrew Bowie, Zachary Ebert
  */
@@ -150,7 +382,8 @@ bool generate_new_pcb(const char *name,
                       void *begin_ptr,
                       const char *input,
                       size_t input_len,
-                      size_t param_ptrs);
+                      size_t param_ptrs,
+                      size_t stack_size);
 
 /**
  * @brief Runs the PCB command from the given string.
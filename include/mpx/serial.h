@@ -26,22 +26,33 @@ typedef enum {
 } io_req_result;
 
 /**
- * @brief Checks for any completed PCBs that were doing IO operations.
+ * @brief Checks for any completed PCBs that were doing IO operations. Completed devices are found through
+ * a bitmask set by the ISRs, so neither the devices nor the blocked PCBs are scanned. If other requests are
+ * waiting on the device, the next one is started.
  * @return a PCB to load, or NULL.
  */
 struct pcb *check_completed(void);
 
 /**
- * @brief Performs an IO operation on the given device, returning the result.
+ * @brief Checks if any IO operation has finished without its PCB being loaded yet, without loading it.
+ * @return true if check_completed would return a PCB.
+ */
+bool io_completion_pending(void);
+
+/**
+ * @brief Performs an IO operation on the given device, returning the result. If the operation finishes right
+ * away the PCB doesn't have to wait for it, otherwise check_completed returns the PCB once it finishes, with the
+ * amount of bytes transferred stored in the EAX of its saved context.
  *
  * @param pcb the PCB requesting this operation.
  * @param operation the operation.
  * @param dev the device.
  * @param buffer the buffer.
  * @param length the amount of characters to transfer.
+ * @param transferred set to the amount of bytes transferred, if the operation was serviced right away.
  * @return the result of the operation.
  */
-io_req_result io_request(struct pcb *pcb, op_code operation, device dev, char *buffer, size_t length);
+io_req_result io_request(struct pcb *pcb, op_code operation, device dev, char *buffer, size_t length, size_t *transferred);
 
 /**
  Initializes devices for user input and output
@@ -0,0 +1,49 @@
+#ifndef MPX_SYS_CALL_H
+#define MPX_SYS_CALL_H
+
+#include "mpx/pcb.h"
+#include "sys_req.h"
+
+/**
+ @file mpx/sys_call.h
+ @brief The scheduler entry points implemented in sys_call.c.
+*/
+
+/**
+ * @brief The main system call function, called by sys_call_isr.
+ * @param action the action to perform.
+ * @param ctx the context of the calling process.
+ * @return a pointer to the next context to load.
+ */
+struct context *sys_call(op_code action, struct context *ctx);
+
+/**
+ * @brief Preempts the running process if another one should run instead, called by the timer when the
+ * running process' quantum expires. Only ready processes ranked the same or higher, or processes whose IO
+ * operation finished, take its place.
+ * @param ctx the context of the interrupted process.
+ * @return a pointer to the next context to load, which is ctx if no switch happened.
+ */
+struct context *preempt_pcb(struct context *ctx);
+
+/**
+ * @brief Switches out the running real-time process once its job used up its budget. It sleeps until the job's
+ * deadline, when its next job is released, or goes straight back to the ready queues if the deadline passed.
+ * @param ctx the context of the interrupted process.
+ * @return a pointer to the next context to load, which is ctx if no other process can run.
+ */
+struct context *throttle_pcb(struct context *ctx);
+
+/**
+ * @brief Halts the CPU until an interrupt arrives, if no process is ready and no IO operation has finished.
+ * Called by the idle process once it has given every other process a chance to run.
+ */
+void cpu_idle(void);
+
+/**
+ * @brief Gets the process that is currently running.
+ * @return the running PCB, or NULL if the kernel itself is running.
+ */
+struct pcb *get_active_pcb(void);
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef MPX_TIMER_H
+#define MPX_TIMER_H
+
+#include "stdbool.h"
+#include "mpx/pcb.h"
+
+/**
+ @file mpx/timer.h
+ @brief Kernel functions for the programmable interval timer, which drives preemptive time slicing.
+*/
+
+///The frequency the PIT counts down at, in hertz.
+#define PIT_BASE_FREQUENCY 1193182
+///The timer interrupt rate used by kmain, in hertz.
+#define TIMER_DEFAULT_HZ 100
+///The amount of timer ticks a process may run before it's preempted, used by kmain.
+#define TIMER_DEFAULT_QUANTUM 5
+
+/**
+ * @brief Programs the PIT to interrupt at the given rate, installs the timer ISR and unmasks IRQ0.
+ * @param frequency the interrupt rate in hertz, clamped to what the PIT supports (19 - 1193182).
+ * @param quantum the amount of ticks a process may run before it's preempted, 0 to never preempt.
+ */
+void timer_init(unsigned int frequency, unsigned int quantum);
+
+/**
+ * @brief Gets the rate the timer interrupts at.
+ * @return the actual frequency in hertz, 0 if the timer hasn't been initialized.
+ */
+unsigned int get_timer_frequency(void);
+
+/**
+ * @brief Gets the amount of timer interrupts since the timer was initialized.
+ * @return the tick count.
+ */
+unsigned long long get_timer_ticks(void);
+
+/**
+ * @brief Sets the amount of ticks a process may run before it's preempted.
+ * @param quantum the amount of ticks, 0 to never preempt.
+ */
+void set_time_quantum(unsigned int quantum);
+
+/**
+ * @brief Gets the amount of ticks a process may run before it's preempted.
+ * @return the amount of ticks.
+ */
+unsigned int get_time_quantum(void);
+
+/**
+ * @brief Gets the load averages, the average amount of runnable processes over the last 1, 5 and 15 minutes.
+ * They're sampled every 5 seconds, and decay exponentially.
+ * @param loads filled with the three load averages, in hundredths.
+ */
+void get_load_averages(unsigned int loads[3]);
+
+/**
+ * @brief Converts milliseconds to timer ticks, rounding up.
+ * @param ms the amount of milliseconds.
+ * @return the amount of ticks, 0 if the timer hasn't been initialized.
+ */
+unsigned int ms_to_ticks(unsigned int ms);
+
+/**
+ * @brief Converts timer ticks to milliseconds.
+ * @param ticks the amount of ticks.
+ * @return the amount of milliseconds, 0 if the timer hasn't been initialized.
+ */
+unsigned int ticks_to_ms(unsigned int ticks);
+
+/**
+ * @brief Parks the PCB in the sleep queue until the given tick, when the timer moves it back to the ready queues.
+ * The PCB costs nothing while it sleeps, and the caller is responsible for blocking it.
+ * @param pcb_ptr the PCB.
+ * @param wake_tick the tick to wake the PCB up at.
+ * @return true if the PCB is sleeping, false if the heap is full.
+ */
+bool timer_sleep(struct pcb *pcb_ptr, unsigned long long wake_tick);
+
+/**
+ * @brief Removes the PCB from the sleep queue, if it's sleeping. It isn't moved back to the ready queues.
+ * @param pcb_ptr the PCB.
+ */
+void timer_cancel_sleep(struct pcb *pcb_ptr);
+
+/**
+ * @brief Gets the tick the next sleeping PCB wakes up at.
+ * @return the tick, or 0 if no PCB is sleeping.
+ */
+unsigned long long next_wake_tick(void);
+
+/**
+ * @brief Halts the CPU until the next interrupt. While halted the timer stops ticking periodically and
+ * is instead programmed to fire once, at the given tick or as late as the PIT allows, and the tick count
+ * is caught up on wakeup. Must be called with interrupts disabled, and returns with them disabled.
+ * @param wake_tick the tick to wake up at, or 0 to wake only for other interrupts.
+ */
+void timer_idle(unsigned long long wake_tick);
+
+/**
+ * @brief Gives the running process a full quantum. Called whenever a new process is dispatched.
+ */
+void reset_time_quantum(void);
+
+#endif
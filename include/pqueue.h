@@ -0,0 +1,125 @@
+#ifndef F_R_I_D_A_Y_PQUEUE_H
+#define F_R_I_D_A_Y_PQUEUE_H
+
+#include "stdbool.h"
+#include "stddef.h"
+
+/**
+ * @file pqueue.h
+ * @brief An array backed binary min heap. Like dlist, the node is embedded into the item being queued.
+ * Every node remembers its index in the heap, so an item can be removed or have its key changed in O(log n)
+ * without searching for it first.
+ */
+
+#ifndef container_of
+/**
+ * @brief Gets a pointer to the structure containing the given member.
+ * @param ptr the pointer to the member.
+ * @param type the type of the containing structure.
+ * @param member the name of the member within the structure.
+ */
+#define container_of(ptr, type, member) ((type *) ((char *) (ptr) - offsetof(type, member)))
+#endif
+
+/**
+ * @brief Gets the structure containing the given heap node, or NULL if the node is NULL.
+ * @param node the heap node.
+ * @param type the type of the containing structure.
+ * @param member the name of the pq_node member within the structure.
+ */
+#define pq_entry(node, type, member) ((node) == NULL ? NULL : container_of(node, type, member))
+
+///The node embedded into every item stored in a pqueue.
+typedef struct
+{
+    ///The index of this node in the heap array, -1 if it isn't queued.
+    int index;
+} pq_node;
+
+///The priority queue itself.
+typedef struct
+{
+    ///The heap ordered array of nodes.
+    pq_node **nodes;
+    ///The amount of nodes in the queue.
+    int size;
+    ///The amount of nodes that fit before the array has to grow.
+    int capacity;
+    ///Compares two nodes, the smallest is at the front of the queue.
+    int (*cmp)(pq_node *node1, pq_node *node2);
+} pqueue_t;
+
+/**
+ * @brief Initializes the queue. You should call @code pq_destroy(queue) when finished with it.
+ *
+ * @param queue the queue.
+ * @param cmp the comparison function, where smaller nodes come first.
+ * @param capacity the initial capacity, which may be 0.
+ * @return true if successful, false if the heap is full.
+ */
+bool pq_init(pqueue_t *queue, int (*cmp)(pq_node *, pq_node *), int capacity);
+
+/**
+ * @brief Frees the memory held by the queue. The queued items themselves are not touched.
+ *
+ * @param queue the queue.
+ */
+void pq_destroy(pqueue_t *queue);
+
+/**
+ * @brief Initializes the node as not being queued.
+ *
+ * @param node the node.
+ */
+void pq_node_init(pq_node *node);
+
+/**
+ * @brief Checks if the node is currently queued.
+ *
+ * @param node the node.
+ * @return true if it's in a queue.
+ */
+bool pq_queued(const pq_node *node);
+
+/**
+ * @brief Adds the node to the queue. O(log n).
+ *
+ * @param queue the queue.
+ * @param node the node, which must not be queued.
+ * @return true if added, false if the heap is full.
+ */
+bool pq_push(pqueue_t *queue, pq_node *node);
+
+/**
+ * @brief Gets the smallest node in the queue. O(1).
+ *
+ * @param queue the queue.
+ * @return the smallest node, or NULL if the queue is empty.
+ */
+pq_node *pq_peek(const pqueue_t *queue);
+
+/**
+ * @brief Removes and returns the smallest node in the queue. O(log n).
+ *
+ * @param queue the queue.
+ * @return the smallest node, or NULL if the queue is empty.
+ */
+pq_node *pq_pop(pqueue_t *queue);
+
+/**
+ * @brief Removes the node from the queue, wherever it is. O(log n). Does nothing if it isn't queued.
+ *
+ * @param queue the queue the node is in.
+ * @param node the node.
+ */
+void pq_remove(pqueue_t *queue, pq_node *node);
+
+/**
+ * @brief Restores the queue's order after the node's key changed, for example a decrease-key. O(log n).
+ *
+ * @param queue the queue the node is in.
+ * @param node the node whose key changed.
+ */
+void pq_update(pqueue_t *queue, pq_node *node);
+
+#endif //F_R_I_D_A_Y_PQUEUE_H
@@ -1,11 +1,16 @@
 #ifndef MPX_STDLIB_H
 #define MPX_STDLIB_H
 
+#include <stddef.h>
+
 /**
  @file stdlib.h
  @brief A subset of standard C library functions.
 */
 
+///The maximum amount of digits an unsigned int can take up in any base (base 2).
+#define UTOA_MAX_DIGITS 32
+
 /**
  Convert an ASCII string to an integer
  @param s A NUL-terminated string
@@ -32,6 +37,16 @@ char *itoa(int i, char *str_buf, int buf_len);
  */
 char *itoa_base(int i, int base, char *str_buf, int buf_len);
 
+/**
+ * @brief Writes the digits of an unsigned integer backwards, ending just before the given pointer.
+ *        No sign or null terminator is written. Base 10 uses a two-digit lookup table.
+ * @param value the value to convert.
+ * @param base the base of the number, 2 to 36.
+ * @param end one past the last byte to write to. At least @code UTOA_MAX_DIGITS bytes must precede it.
+ * @return a pointer to the first (most significant) digit written.
+ */
+char *utoa_digits(unsigned int value, int base, char *end);
+
 /**
  * @brief Convert a hex string to integer
  * @param s the string to convert
@@ -39,4 +54,25 @@ char *itoa_base(int i, int base, char *str_buf, int buf_len);
  */
 int atox(const char *s);
 
+/**
+ * @brief Sorts an array in place. This is an introsort: quick sort with a median of three
+ *        pivot that falls back to heap sort on bad inputs, finishing small ranges with
+ *        insertion sort. O(n log n) in the worst case. The sort is NOT stable.
+ * @param base the first element of the array.
+ * @param count the amount of elements in the array.
+ * @param size the size of each element.
+ * @param cmp the comparison function, returning <0, 0 or >0 like strcmp.
+ */
+void qsort(void *base, size_t count, size_t size, int (*cmp)(const void *, const void *));
+
+/**
+ * @brief Sorts the keys in ascending order with an LSD radix sort, one byte per pass.
+ *        The sort is stable and runs in O(n), but allocates scratch space from the heap.
+ * @param keys the keys to sort.
+ * @param values values moved alongside the keys, or NULL if there are none.
+ * @param count the amount of keys.
+ * @return 0 on success, -1 if the scratch space could not be allocated.
+ */
+int radix_sort(unsigned int *keys, void **values, size_t count);
+
 #endif
@@ -111,6 +111,24 @@ char *str_to_lower(char *str, char *buffer, int buf_len);
 */
 char* strtok(char * restrict s1, const char * restrict s2);
 
+/**
+ * @brief A function that receives formatted output, chunk by chunk.
+ * Chunks are NOT null terminated and are only valid for the duration of the call.
+ */
+typedef void (*format_sink_t)(void *ctx, const char *chunk, size_t len);
+
+/**
+ * @brief Formats the string with normal C formatting options, streaming the output into the sink.
+ *        Supports %s, %c, %d, %u, %x and %%, with zero filled widths such as %02d.
+ *        There is no limit on the length of the output.
+ * @param sink the function receiving the output.
+ * @param ctx a pointer passed through to the sink.
+ * @param format the string format.
+ * @param varargs the formatting values.
+ * @return the amount of characters emitted, or -1 if the format was invalid.
+ */
+int vformat(format_sink_t sink, void *ctx, const char *format, va_list varargs);
+
 /**
  * @brief Formats the string with normal C formatting options.
  * @param format the string format.
@@ -126,8 +144,8 @@ char *sprintf(const char *format, char *str, size_t buf_len, ...);
  * @param format the string format.
  * @param str the buffer to store the resulting string in.
  * @param buf_len the length of the provided string buffer.
- * @param ... the formatting values.
- * @return the formatted string.
+ * @param varargs the formatting values.
+ * @return the formatted string, truncated to fit the buffer, or NULL if the format was invalid.
  */
 char *vsprintf(const char *format, char *str, size_t buf_len, va_list varargs);
 
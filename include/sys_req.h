@@ -12,7 +12,11 @@ typedef enum {
 	EXIT,
 	IDLE,
 	READ,
-	WRITE
+	WRITE,
+	/** Sleep for the given amount of milliseconds (unsigned int) */
+	SLEEP,
+	/** Sleep until the timer reaches the given tick (unsigned long long) */
+	SLEEP_UNTIL
 } op_code;
     
 // error codes
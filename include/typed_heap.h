@@ -0,0 +1,102 @@
+#ifndef F_R_I_D_A_Y_TYPED_HEAP_H
+#define F_R_I_D_A_Y_TYPED_HEAP_H
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "memory.h"
+
+/**
+ * @file typed_heap.h
+ * @brief A type specialized binary min heap. Where pqueue.h links nodes embedded in other structures and
+ * orders them through a comparison function pointer, this heap stores the elements themselves and
+ * expands the comparison inline at every sift.
+ *
+ * @code
+ * #define uint_less(a, b) ((a) < (b))
+ * DEFINE_HEAP(uint_heap, unsigned int, uint_less)
+ * @endcode
+ */
+
+/**
+ * @brief Generates a fixed capacity min heap of the given type. Creates name_t and the functions name_init,
+ * name_destroy, name_push, name_peek and name_pop.
+ * @param name the prefix of the generated type and functions.
+ * @param type the element type.
+ * @param less a function or macro taking two elements, true if the first belongs above the second.
+ */
+#define DEFINE_HEAP(name, type, less) \
+    typedef struct { \
+        type *data; \
+        int size; \
+        int capacity; \
+    } name##_t; \
+    \
+    static inline bool name##_init(name##_t *heap, int capacity) \
+    { \
+        heap->size = 0; \
+        heap->capacity = capacity; \
+        heap->data = sys_alloc_mem((size_t) capacity * sizeof(type)); \
+        return heap->data != NULL; \
+    } \
+    \
+    static inline void name##_destroy(name##_t *heap) \
+    { \
+        if(heap->data != NULL) \
+            sys_free_mem(heap->data); \
+        heap->data = NULL; \
+        heap->size = heap->capacity = 0; \
+    } \
+    \
+    static inline bool name##_push(name##_t *heap, type elem) \
+    { \
+        if(heap->size == heap->capacity) \
+            return false; \
+        /* Move parents down into the hole until the element fits. */ \
+        int index = heap->size++; \
+        while (index > 0) \
+        { \
+            int parent = (index - 1) / 2; \
+            if(!(less(elem, heap->data[parent]))) \
+                break; \
+            heap->data[index] = heap->data[parent]; \
+            index = parent; \
+        } \
+        heap->data[index] = elem; \
+        return true; \
+    } \
+    \
+    static inline bool name##_peek(const name##_t *heap, type *out) \
+    { \
+        if(heap->size == 0) \
+            return false; \
+        *out = heap->data[0]; \
+        return true; \
+    } \
+    \
+    static inline bool name##_pop(name##_t *heap, type *out) \
+    { \
+        if(heap->size == 0) \
+            return false; \
+        if(out != NULL) \
+            *out = heap->data[0]; \
+        type last = heap->data[--heap->size]; \
+        /* Move the smaller child up into the hole until the last element fits. */ \
+        int index = 0; \
+        while (true) \
+        { \
+            int child = index * 2 + 1; \
+            if(child >= heap->size) \
+                break; \
+            if(child + 1 < heap->size && less(heap->data[child + 1], heap->data[child])) \
+                child++; \
+            if(!(less(heap->data[child], last))) \
+                break; \
+            heap->data[index] = heap->data[child]; \
+            index = child; \
+        } \
+        if(heap->size > 0) \
+            heap->data[index] = last; \
+        return true; \
+    }
+
+#endif //F_R_I_D_A_Y_TYPED_HEAP_H
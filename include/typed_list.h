@@ -0,0 +1,120 @@
+#ifndef F_R_I_D_A_Y_TYPED_LIST_H
+#define F_R_I_D_A_Y_TYPED_LIST_H
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "memory.h"
+
+/**
+ * @file typed_list.h
+ * @brief A type specialized version of linked_list.h. The element is stored by value inside its node,
+ * and sorted insertion expands the comparison inline instead of calling a sort function per node.
+ *
+ * @code
+ * #define uint_cmpr(a, b) ((a) < (b) ? -1 : (a) > (b))
+ * DEFINE_LIST(uint_list, unsigned int, uint_cmpr)
+ * @endcode
+ */
+
+/**
+ * @brief Iterates over every node in a typed list, front to back. The current node must not be removed.
+ * @param list the list.
+ * @param iter the name of the node pointer variable, the element is iter->value.
+ */
+#define typed_list_for_each(list, iter) \
+    for (__typeof__((list)->head.next) iter = (list)->head.next; iter != &(list)->head; iter = iter->next)
+
+/**
+ * @brief Generates a doubly linked list of the given type. Creates name_node_t, name_t and the functions
+ * name_init, name_destroy, name_insert_before, name_push_front, name_push_back, name_insert_sorted,
+ * name_remove, name_pop_front and name_pop_back.
+ * @param name the prefix of the generated types and functions.
+ * @param type the element type.
+ * @param cmp a function or macro comparing two elements, negative, 0 or positive like strcmp.
+ */
+#define DEFINE_LIST(name, type, cmp) \
+    typedef struct name##_node_ { \
+        struct name##_node_ *prev; \
+        struct name##_node_ *next; \
+        type value; \
+    } name##_node_t; \
+    \
+    typedef struct { \
+        name##_node_t head; \
+        int size; \
+    } name##_t; \
+    \
+    static inline void name##_init(name##_t *list) \
+    { \
+        list->head.prev = list->head.next = &list->head; \
+        list->size = 0; \
+    } \
+    \
+    static inline bool name##_insert_before(name##_t *list, name##_node_t *pos, type elem) \
+    { \
+        name##_node_t *node = sys_alloc_mem(sizeof(name##_node_t)); \
+        if(node == NULL) \
+            return false; \
+        node->value = elem; \
+        node->next = pos; \
+        node->prev = pos->prev; \
+        pos->prev->next = node; \
+        pos->prev = node; \
+        list->size++; \
+        return true; \
+    } \
+    \
+    static inline bool name##_push_front(name##_t *list, type elem) \
+    { \
+        return name##_insert_before(list, list->head.next, elem); \
+    } \
+    \
+    static inline bool name##_push_back(name##_t *list, type elem) \
+    { \
+        return name##_insert_before(list, &list->head, elem); \
+    } \
+    \
+    static inline bool name##_insert_sorted(name##_t *list, type elem) \
+    { \
+        /* Walk from the back like dlist_insert_sorted, so equal elements keep their order. */ \
+        name##_node_t *pos = &list->head; \
+        while (pos->prev != &list->head && cmp(elem, pos->prev->value) < 0) \
+            pos = pos->prev; \
+        return name##_insert_before(list, pos, elem); \
+    } \
+    \
+    static inline void name##_remove(name##_t *list, name##_node_t *node) \
+    { \
+        node->prev->next = node->next; \
+        node->next->prev = node->prev; \
+        list->size--; \
+        sys_free_mem(node); \
+    } \
+    \
+    static inline bool name##_pop_front(name##_t *list, type *out) \
+    { \
+        if(list->size == 0) \
+            return false; \
+        if(out != NULL) \
+            *out = list->head.next->value; \
+        name##_remove(list, list->head.next); \
+        return true; \
+    } \
+    \
+    static inline bool name##_pop_back(name##_t *list, type *out) \
+    { \
+        if(list->size == 0) \
+            return false; \
+        if(out != NULL) \
+            *out = list->head.prev->value; \
+        name##_remove(list, list->head.prev); \
+        return true; \
+    } \
+    \
+    static inline void name##_destroy(name##_t *list) \
+    { \
+        while (list->size > 0) \
+            name##_remove(list, list->head.next); \
+    }
+
+#endif //F_R_I_D_A_Y_TYPED_LIST_H
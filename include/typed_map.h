@@ -0,0 +1,195 @@
+#ifndef F_R_I_D_A_Y_TYPED_MAP_H
+#define F_R_I_D_A_Y_TYPED_MAP_H
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "memory.h"
+#include "string.h"
+
+/**
+ * @file typed_map.h
+ * @brief A type specialized version of hash_map.h. It uses the same Robin Hood table, but keys and values
+ * are stored by value in the slots and the hash and equality are expanded inline, so looking up an integer
+ * key never leaves the caller's function.
+ *
+ * @code
+ * #define int_equals(a, b) ((a) == (b))
+ * DEFINE_HASH_MAP(int_map, int, int, hash_int, int_equals)
+ * @endcode
+ */
+
+///The capacity of a typed map when it's first initialized.
+#define TYPED_MAP_MIN_CAPACITY 16
+
+/**
+ * @brief Generates a hash map from the key type to the value type. Creates name_slot_t, name_t and the functions
+ * name_init, name_destroy, name_reserve, name_put, name_get, name_remove and name_clear.
+ * @param name the prefix of the generated types and functions.
+ * @param key_type the key type.
+ * @param value_type the value type.
+ * @param hash a function or macro hashing a key to an unsigned int.
+ * @param equals a function or macro taking two keys, true if they are equal.
+ */
+#define DEFINE_HASH_MAP(name, key_type, value_type, hash, equals) \
+    typedef struct { \
+        key_type key; \
+        value_type value; \
+        unsigned int hash_code; \
+    } name##_slot_t; \
+    \
+    typedef struct { \
+        name##_slot_t *slots; \
+        int size; \
+        int capacity; \
+    } name##_t; \
+    \
+    static inline unsigned int name##_hash(key_type key) \
+    { \
+        /* Mixed like hash_map, the top bit set so 0 can mark an empty slot. */ \
+        unsigned int code = (unsigned int) (hash(key)); \
+        code ^= code >> 16; \
+        code *= 0x45D9F3BU; \
+        code ^= code >> 16; \
+        return code | 0x80000000U; \
+    } \
+    \
+    static inline int name##_distance(const name##_t *map, int index) \
+    { \
+        return (index - (int) (map->slots[index].hash_code & (unsigned int) (map->capacity - 1))) & (map->capacity - 1); \
+    } \
+    \
+    static inline void name##_insert_slot(name##_t *map, name##_slot_t slot) \
+    { \
+        int mask = map->capacity - 1; \
+        int index = (int) (slot.hash_code & (unsigned int) mask); \
+        int distance = 0; \
+        while (map->slots[index].hash_code != 0) \
+        { \
+            int slot_distance = name##_distance(map, index); \
+            if(slot_distance < distance) \
+            { \
+                name##_slot_t displaced = map->slots[index]; \
+                map->slots[index] = slot; \
+                slot = displaced; \
+                distance = slot_distance; \
+            } \
+            index = (index + 1) & mask; \
+            distance++; \
+        } \
+        map->slots[index] = slot; \
+        map->size++; \
+    } \
+    \
+    static inline int name##_find(const name##_t *map, key_type key, unsigned int hash_code) \
+    { \
+        int mask = map->capacity - 1; \
+        int index = (int) (hash_code & (unsigned int) mask); \
+        for (int distance = 0; distance < map->capacity; ++distance) \
+        { \
+            const name##_slot_t *slot = &map->slots[index]; \
+            if(slot->hash_code == 0 || name##_distance(map, index) < distance) \
+                return -1; \
+            if(slot->hash_code == hash_code && (equals(slot->key, key))) \
+                return index; \
+            index = (index + 1) & mask; \
+        } \
+        return -1; \
+    } \
+    \
+    static inline bool name##_resize(name##_t *map, int capacity) \
+    { \
+        name##_slot_t *new_slots = sys_alloc_mem((size_t) capacity * sizeof(name##_slot_t)); \
+        if(new_slots == NULL) \
+            return false; \
+        memset(new_slots, 0, (size_t) capacity * sizeof(name##_slot_t)); \
+        name##_slot_t *old_slots = map->slots; \
+        int old_capacity = map->capacity; \
+        map->slots = new_slots; \
+        map->capacity = capacity; \
+        map->size = 0; \
+        if(old_slots != NULL) \
+        { \
+            for (int i = 0; i < old_capacity; ++i) \
+            { \
+                if(old_slots[i].hash_code != 0) \
+                    name##_insert_slot(map, old_slots[i]); \
+            } \
+            sys_free_mem(old_slots); \
+        } \
+        return true; \
+    } \
+    \
+    static inline bool name##_init(name##_t *map) \
+    { \
+        map->slots = NULL; \
+        map->size = map->capacity = 0; \
+        return name##_resize(map, TYPED_MAP_MIN_CAPACITY); \
+    } \
+    \
+    static inline void name##_destroy(name##_t *map) \
+    { \
+        if(map->slots != NULL) \
+            sys_free_mem(map->slots); \
+        map->slots = NULL; \
+        map->size = map->capacity = 0; \
+    } \
+    \
+    static inline bool name##_reserve(name##_t *map, int count) \
+    { \
+        /* A map that was zeroed or failed to initialize has no table to double yet. */ \
+        int new_capacity = map->capacity == 0 ? TYPED_MAP_MIN_CAPACITY : map->capacity; \
+        while (count * 4 > new_capacity * 3) \
+            new_capacity *= 2; \
+        return new_capacity == map->capacity || name##_resize(map, new_capacity); \
+    } \
+    \
+    static inline bool name##_put(name##_t *map, key_type key, value_type value) \
+    { \
+        unsigned int hash_code = name##_hash(key); \
+        int index = name##_find(map, key, hash_code); \
+        if(index >= 0) \
+        { \
+            map->slots[index].value = value; \
+            return true; \
+        } \
+        if(!name##_reserve(map, map->size + 1) && map->size >= map->capacity) \
+            return false; \
+        name##_slot_t slot = {.key = key, .value = value, .hash_code = hash_code}; \
+        name##_insert_slot(map, slot); \
+        return true; \
+    } \
+    \
+    static inline value_type *name##_get(const name##_t *map, key_type key) \
+    { \
+        int index = name##_find(map, key, name##_hash(key)); \
+        return index >= 0 ? &map->slots[index].value : NULL; \
+    } \
+    \
+    static inline bool name##_remove(name##_t *map, key_type key, value_type *out) \
+    { \
+        int index = name##_find(map, key, name##_hash(key)); \
+        if(index < 0) \
+            return false; \
+        if(out != NULL) \
+            *out = map->slots[index].value; \
+        /* Shift the following slots back until one is empty or already home. */ \
+        int mask = map->capacity - 1; \
+        int next = (index + 1) & mask; \
+        while (map->slots[next].hash_code != 0 && name##_distance(map, next) > 0) \
+        { \
+            map->slots[index] = map->slots[next]; \
+            index = next; \
+            next = (next + 1) & mask; \
+        } \
+        map->slots[index].hash_code = 0; \
+        map->size--; \
+        return true; \
+    } \
+    \
+    static inline void name##_clear(name##_t *map) \
+    { \
+        memset(map->slots, 0, (size_t) map->capacity * sizeof(name##_slot_t)); \
+        map->size = 0; \
+    }
+
+#endif //F_R_I_D_A_Y_TYPED_MAP_H
@@ -0,0 +1,110 @@
+#ifndef F_R_I_D_A_Y_TYPED_VECTOR_H
+#define F_R_I_D_A_Y_TYPED_VECTOR_H
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "memory.h"
+
+/**
+ * @file typed_vector.h
+ * @brief A type specialized version of vector.h. Instead of copying elem_size bytes through void
+ * pointers, the generated functions move elements by assignment, so the compiler can keep them in
+ * registers and inline every call.
+ *
+ * @code
+ * DEFINE_VECTOR(int_vec, int)
+ *
+ * int_vec_t vec;
+ * int_vec_init(&vec, 0);
+ * int_vec_push(&vec, 5);
+ * @endcode
+ */
+
+///The capacity a typed vector grows to when it first needs memory.
+#define TYPED_VECTOR_MIN_CAPACITY 8
+
+/**
+ * @brief Generates a vector of the given type. Creates name_t and the functions name_init, name_destroy,
+ * name_reserve, name_push, name_pop, name_at, name_swap_remove and name_clear, which behave like their
+ * vec_ counterparts.
+ * @param name the prefix of the generated type and functions.
+ * @param type the element type.
+ */
+#define DEFINE_VECTOR(name, type) \
+    typedef struct { \
+        type *data; \
+        int size; \
+        int capacity; \
+    } name##_t; \
+    \
+    static inline bool name##_reserve(name##_t *vec, int capacity) \
+    { \
+        if(capacity <= vec->capacity) \
+            return true; \
+        type *new_data = sys_alloc_mem((size_t) capacity * sizeof(type)); \
+        if(new_data == NULL) \
+            return false; \
+        for (int i = 0; i < vec->size; ++i) \
+            new_data[i] = vec->data[i]; \
+        if(vec->data != NULL) \
+            sys_free_mem(vec->data); \
+        vec->data = new_data; \
+        vec->capacity = capacity; \
+        return true; \
+    } \
+    \
+    static inline bool name##_init(name##_t *vec, int capacity) \
+    { \
+        vec->data = NULL; \
+        vec->size = vec->capacity = 0; \
+        return capacity <= 0 || name##_reserve(vec, capacity); \
+    } \
+    \
+    static inline void name##_destroy(name##_t *vec) \
+    { \
+        if(vec->data != NULL) \
+            sys_free_mem(vec->data); \
+        vec->data = NULL; \
+        vec->size = vec->capacity = 0; \
+    } \
+    \
+    static inline bool name##_push(name##_t *vec, type elem) \
+    { \
+        if(vec->size == vec->capacity && \
+                !name##_reserve(vec, vec->capacity < TYPED_VECTOR_MIN_CAPACITY ? TYPED_VECTOR_MIN_CAPACITY : vec->capacity * 2)) \
+            return false; \
+        vec->data[vec->size++] = elem; \
+        return true; \
+    } \
+    \
+    static inline bool name##_pop(name##_t *vec, type *out) \
+    { \
+        if(vec->size == 0) \
+            return false; \
+        vec->size--; \
+        if(out != NULL) \
+            *out = vec->data[vec->size]; \
+        return true; \
+    } \
+    \
+    static inline type *name##_at(name##_t *vec, int index) \
+    { \
+        return index < 0 || index >= vec->size ? NULL : &vec->data[index]; \
+    } \
+    \
+    static inline bool name##_swap_remove(name##_t *vec, int index, type *out) \
+    { \
+        if(index < 0 || index >= vec->size) \
+            return false; \
+        if(out != NULL) \
+            *out = vec->data[index]; \
+        vec->data[index] = vec->data[--vec->size]; \
+        return true; \
+    } \
+    \
+    static inline void name##_clear(name##_t *vec) \
+    { \
+        vec->size = 0; \
+    }
+
+#endif //F_R_I_D_A_Y_TYPED_VECTOR_H
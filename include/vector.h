@@ -0,0 +1,96 @@
+#ifndef F_R_I_D_A_Y_VECTOR_H
+#define F_R_I_D_A_Y_VECTOR_H
+
+#include "stdbool.h"
+#include "stddef.h"
+
+/**
+ * @file vector.h
+ * @brief A growable array storing its elements contiguously by value. Pushing is amortized O(1),
+ * as the capacity doubles whenever it runs out.
+ */
+
+///The structure holding the vector's data.
+typedef struct {
+    ///The elements, contiguous in memory.
+    void *data;
+    ///The size of a single element, in bytes.
+    size_t elem_size;
+    ///The amount of elements in the vector.
+    int size;
+    ///The amount of elements that fit before the vector has to grow.
+    int capacity;
+} vector_t;
+
+/**
+ * @brief Initializes the vector. You should call @code vec_destroy(vec) when finished with it.
+ *
+ * @param vec the vector.
+ * @param elem_size the size of each element.
+ * @param capacity the initial capacity, which may be 0.
+ * @return true if successful, false if the heap is full.
+ */
+bool vec_init(vector_t *vec, size_t elem_size, int capacity);
+
+/**
+ * @brief Frees the memory held by the vector. The vector may be initialized again afterwards.
+ *
+ * @param vec the vector.
+ */
+void vec_destroy(vector_t *vec);
+
+/**
+ * @brief Grows the vector so it can hold the given amount of elements without allocating.
+ *
+ * @param vec the vector.
+ * @param capacity the capacity required.
+ * @return true if successful, false if the heap is full.
+ */
+bool vec_reserve(vector_t *vec, int capacity);
+
+/**
+ * @brief Copies the element onto the end of the vector.
+ *
+ * @param vec the vector.
+ * @param elem a pointer to the element, or NULL to zero the new slot.
+ * @return a pointer to the stored element, or NULL if the heap is full.
+ */
+void *vec_push(vector_t *vec, const void *elem);
+
+/**
+ * @brief Removes the last element of the vector.
+ *
+ * @param vec the vector.
+ * @param out where to copy the removed element, may be NULL.
+ * @return true if an element was removed, false if the vector was empty.
+ */
+bool vec_pop(vector_t *vec, void *out);
+
+/**
+ * @brief Gets a pointer to the element at the given index. The pointer is invalidated when the vector grows.
+ *
+ * @param vec the vector.
+ * @param index the index.
+ * @return the element, or NULL if the index is out of bounds.
+ */
+void *vec_at(vector_t *vec, int index);
+
+/**
+ * @brief Removes the element at the given index in O(1) by moving the last element into its place.
+ * This does not keep the order of the elements.
+ *
+ * @param vec the vector.
+ * @param index the index.
+ * @param out where to copy the removed element, may be NULL.
+ * @return true if an element was removed, false if the index is out of bounds.
+ */
+bool vec_swap_remove(vector_t *vec, int index, void *out);
+
+/**
+ * @brief Removes all elements, keeping the memory for reuse.
+ *
+ * @param vec the vector.
+ */
+void vec_clear(vector_t *vec);
+
+#endif //F_R_I_D_A_Y_VECTOR_H
@@ -4,147 +4,152 @@
 #include "string.h"
 #include "mpx/clock.h"
 #include "sys_req.h"
-#include "mpx/pcb.h"
-#include "stdlib.h"
+#include "mpx/alarm.h"
+#include "mpx/timer.h"
+#include "mpx/interrupts.h"
+#include "memory.h"
+#include "pqueue.h"
 
 /**
  * @file alarm.c
- * @brief Contains logic to create alarms for the OS.
+ * @brief Contains logic to create alarms for the OS. Alarms are small entries in one deadline queue, and a single
+ * service process sleeps until the earliest one is due, so pending alarms cost nothing but their entry.
  */
 
-///The parameters used to pass into the alarm function.
-typedef struct alarm_params
+///The name of the process that prints the alarms.
+#define ALARM_SERVICE_NAME "alarms"
+///The priority of the alarm service, high so the alarms are printed on time.
+#define ALARM_SERVICE_PRIORITY 1
+///The deadline the alarm service has to print an alarm by once it's due, in milliseconds.
+#define ALARM_SERVICE_PERIOD_MS 100
+///The run time reserved for the alarm service every period, in milliseconds.
+#define ALARM_SERVICE_BUDGET_MS 10
+///The amount of seconds in a day.
+#define SECONDS_PER_DAY 86400
+///The tick the alarm service sleeps until when there are no alarms.
+#define ALARM_NEVER 0xFFFFFFFFFFFFFFFFULL
+
+///A pending alarm.
+struct alarm
 {
-    ///A pointer to where the time is stored.
-    int *time_ptr;
-    ///A pointer to where the message is stored.
-    char *str_ptr;
-    ///The timezone used to create the alarm.
-    time_zone_t *time_zone;
-    ///The data to store.
-    unsigned char buffer[100];
-} alarm_structure;
+    ///The node in the alarm queue.
+    pq_node node;
+    ///The timer tick the alarm goes off at.
+    unsigned long long due_tick;
+    ///The message to print, stored inline.
+    char message[];
+};
 
 /**
- * Check if the given time array of hours, minutes, seconds is after the other.
- *
- * @param now the time array considered to be 'now'
- * @param check the time to check at.
- * @return true if it is after.
+ * @brief Orders alarms by the tick they go off at.
+ * @param node1 the first alarm's node.
+ * @param node2 the second alarm's node.
+ * @return negative if the first is due first, positive if the second is, 0 if they're due together.
  */
-bool is_time_after(const int *now, const int *check)
+static int alarm_cmp(pq_node *node1, pq_node *node2)
 {
-    //Hours.
-    if(now[0] < check[0])
-        return false;
-    else if(now[0] > check[0])
-        return true;
-
-    //Minutes.
-    if(now[1] < check[1])
-        return false;
-    else if(now[1] > check[1])
-        return true;
-
-    //Seconds.
-    if(now[2] < check[2])
-        return false;
-    else if(now[2] > check[2])
-        return true;
-    return true;
+    unsigned long long due1 = pq_entry(node1, struct alarm, node)->due_tick;
+    unsigned long long due2 = pq_entry(node2, struct alarm, node)->due_tick;
+    return due1 < due2 ? -1 : due1 > due2;
 }
 
-bool shouldAlarm(const int *time_array, time_zone_t *tz)
-{
-    // get current time
-    int time_buf[7];
-    get_time(time_buf);
-    adj_timezone(time_buf, tz->tz_hour_offset, tz->tz_minute_offset);
-    //Check the years.
-    if(time_array[0] > time_buf[0])
-        return false;
+///The pending alarms, the earliest at the front. Shared with the service process, so only used with interrupts off.
+static pqueue_t alarm_queue = {.cmp = &alarm_cmp};
 
-    //Check the month.
-    if(time_array[1] > time_buf[1])
-        return false;
-
-    //Check day.
-    if(time_array[2] > time_buf[2])
-        return false;
-
-    // index 4-6 is hours - seconds
-    if (time_array[4] < time_buf[4])
-        return true;
-    // printf("alarm time is %d:%d:%d current time is %d:%d:%d\n", time_array[0], time_array[1], time_array[2], time_buf[4], time_buf[5], time_buf[6]);
-    if (time_array[4] == time_buf[4] && time_array[5] < time_buf[5])
-        return true;
-    if (time_array[4] == time_buf[4] && time_array[5] == time_buf[5] && time_array[6] <= time_buf[6])
-        return true;
-
-    return false;
+/**
+ * @brief Gets the tick the earliest alarm is due at. Interrupts must be disabled.
+ * @return the tick, or ALARM_NEVER if there are no alarms.
+ */
+static unsigned long long next_alarm_tick(void)
+{
+    pq_node *node = pq_peek(&alarm_queue);
+    return node == NULL ? ALARM_NEVER : pq_entry(node, struct alarm, node)->due_tick;
 }
 
 /**
- * @brief The alarm function used by the alarm processes.
- * @param time_array the time array to go off at.
- * @param message the message to send to the user.
- * @param time_zone the timezone to use for the alarm.
- * @authors Kolby Eisenhauer
+ * @brief The alarm service process. Prints every alarm that's due, then sleeps until the next one.
  */
-void alarm_function(int *time_array, const char *message, time_zone_t *time_zone)
+static void alarm_service(void)
 {
-    while (!shouldAlarm(time_array, time_zone))
+    for (;;)
     {
-        sys_req(IDLE);
+        unsigned int flags = irq_save();
+        pq_node *node = pq_peek(&alarm_queue);
+        struct alarm *due = pq_entry(node, struct alarm, node);
+        if(due != NULL && due->due_tick <= get_timer_ticks())
+        {
+            pq_pop(&alarm_queue);
+            irq_restore(flags);
+
+            println(due->message);
+            sys_free_mem(due);
+            continue;
+        }
+
+        //Interrupts stay off until the sleep begins, so an earlier alarm can't be added in between unnoticed.
+        sys_req(SLEEP_UNTIL, next_alarm_tick());
+        irq_restore(flags);
     }
-
-    println(message);
-    sys_req(EXIT);
 }
 
-///The alarm count used to make sure names are unique.
-static int alarms = 0;
-
+/**
+ * @brief Gets the amount of seconds into the day of the given time array.
+ * @param time_array the time array, with the hours, minutes and seconds at 4 - 6.
+ * @return the amount of seconds.
+ */
+static int seconds_of_day(const int *time_array)
+{
+    return time_array[4] * 3600 + time_array[5] * 60 + time_array[6];
+}
 
 bool create_new_alarm(int *time_array, const char *message)
 {
-    char name[20] = {'a', 'l', 'a', 'r', 'm', '\0'};
+    //Alarms go off at the next occurrence of the time, which may be tomorrow.
+    int time_buf[7] = {0};
+    get_time(time_buf);
+    const time_zone_t *time_zone = get_clock_timezone();
+    adj_timezone(time_buf, time_zone->tz_hour_offset, time_zone->tz_minute_offset);
+
+    int seconds = seconds_of_day(time_array) - seconds_of_day(time_buf);
+    if(seconds <= 0)
+        seconds += SECONDS_PER_DAY;
 
-    //Prepare the parameters for the function.
-    alarm_structure parameters = {0};
-    parameters.str_ptr = (char *) parameters.buffer;
     size_t len = strlen(message);
-    strcpy(parameters.str_ptr, message, len);
-    parameters.time_zone = (time_zone_t *) get_clock_timezone();
+    struct alarm *alarm = sys_alloc_mem(sizeof (struct alarm) + len + 1);
+    if(alarm == NULL)
+        return false;
+    pq_node_init(&alarm->node);
+    memcpy(alarm->message, message, len + 1);
+    alarm->due_tick = get_timer_ticks() + (unsigned long long) seconds * get_timer_frequency();
 
-    int time_buf[7] = {0};
-    get_time(time_buf);
-    adj_timezone(time_buf, parameters.time_zone->tz_hour_offset, parameters.time_zone->tz_minute_offset);
+    //The service is only started once, every alarm after that is just an entry in the queue.
+    if(pcb_find(ALARM_SERVICE_NAME) == NULL)
+    {
+        if(!generate_new_pcb(ALARM_SERVICE_NAME, ALARM_SERVICE_PRIORITY, SYSTEM, &alarm_service, NULL, 0, 0, PCB_SMALL_STACK_SIZE))
+        {
+            sys_free_mem(alarm);
+            return false;
+        }
+
+        //A real-time reservation keeps alarms on time under load. If it's rejected, the high priority has to do.
+        pcb_set_realtime(pcb_find(ALARM_SERVICE_NAME), ALARM_SERVICE_PERIOD_MS, ALARM_SERVICE_BUDGET_MS);
+    }
 
-    //Check if we need to adjust the days.
-    if(is_time_after(time_buf + 4, time_array + 4))
+    unsigned int flags = irq_save();
+    if(!pq_push(&alarm_queue, &alarm->node))
     {
-        adj_timezone(time_array, 24, 0);
+        irq_restore(flags);
+        sys_free_mem(alarm);
+        return false;
     }
 
-    //Copy in the time pointer.
-    parameters.time_ptr = (int *) (parameters.buffer + len + 2);
-    memcpy(parameters.time_ptr, time_array, 7 * sizeof(int));
-
-    //Prepare the process' name.
-    size_t name_len = 15;
-    char process_name[name_len];
-    do {
-        memset(process_name, 0, name_len);
-        strcpy(process_name, name, -1);
-        char num_buf[10] = {0};
-        itoa(alarms, num_buf, 9);
-        strcpy(process_name + strlen(name), num_buf, -1);
-        alarms++;
-    }while(pcb_find(process_name) != NULL);
-
-    //Generate the actual PCB.
-    bool generated = generate_new_pcb(process_name, 1, USER, &alarm_function, (char *) &parameters, sizeof(alarm_structure), 2);
-    return generated;
+    //Wake the service earlier if it's sleeping past the new alarm.
+    struct pcb *service = pcb_find(ALARM_SERVICE_NAME);
+    if(service != NULL && pq_queued(&service->sleep_node) && service->wake_tick > alarm->due_tick)
+    {
+        timer_cancel_sleep(service);
+        timer_sleep(service, alarm->due_tick);
+    }
+    irq_restore(flags);
+    return true;
 }
-
@@ -14,6 +14,7 @@
 #include "mpx/r3cmd.h"
 #include "math.h"
 #include "mpx/pcb.h"
+#include "benchmarks.h"
 
 ///The message to send to the user if a command hasn't been recognized.
 #define UNKNOWN_CMD_MSG "Unknown command '%s'. Type 'help' for help!"
@@ -42,7 +43,10 @@ bool (*comm_funcs[])(const char *comm) = {
         &cmd_show_allocate,
         &cmd_show_free,
         &cmd_dragonmaze,
-        &cmd_minesweeper
+        &cmd_minesweeper,
+        &cmd_bench,
+        &cmd_top,
+        &cmd_sched
 };
 
 /// Used to denote if the comm hand should stop.
@@ -52,8 +56,8 @@ void signal_shutdown(void)
 {
     sig_shutdown = true;
 
-    //Empty the PCB queue.
-    while(poll_next_pcb() != NULL);
+    //Empty the PCB queues.
+    clear_pcb_queues();
 
     sys_req(EXIT);
 }
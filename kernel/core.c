@@ -232,6 +232,7 @@ noreturn void kpanic(const char *msg)
 #include <limits.h>
 #include <string.h>
 #include <stdint.h>
+#include <bitset.h>
 
 // The physical start of the heap
 // TODO: this is very magic
@@ -250,9 +251,6 @@ noreturn void kpanic(const char *msg)
 // number of frames
 #define NFRAMES		(MEM_SIZE / PAGE_SIZE)
 
-// bits per frame
-#define FRAME_BIT	(sizeof(uint32_t) * CHAR_BIT)
-
 /*
   Page entry structure
   Describes a single page in memory
@@ -285,7 +283,8 @@ typedef struct {
 } page_dir;
 
 // bitmap of frames
-static uint32_t frames[NFRAMES / FRAME_BIT] = { 0 };
+static unsigned int frame_words[BITSET_WORDS(NFRAMES)] = { 0 };
+static bitset_t frames = BITSET_INIT(frame_words, NFRAMES);
 
 // kernel page directory
 static page_dir *kdir;
@@ -368,26 +367,16 @@ void *kmalloc(uint32_t size, int page_align, void **phys_addr)
 	return addr;
 }
 
-/* Finds the first free page frame */
+/* Finds the first free page frame, skipping full words with bsf */
 static uint32_t find_free()
 {
-	uint32_t i, j;
-	for (i = 0; i < NFRAMES / FRAME_BIT; i++)
-		if (frames[i] != 0xFFFFFFFF)	//if frame not full
-			for (j = 0; j < FRAME_BIT; j++)	//find first free bit
-				if (!(frames[i] & (1 << j)))
-					return i * FRAME_BIT + j;
-
-	return -1;		//no free frames
+	return (uint32_t) bitset_find_first_zero(&frames, 0);	//-1 if no free frames
 }
 
 /* Marks a page frame bit as in use */
 static void set_bit(uint32_t addr)
 {
-	uint32_t frame = addr / PAGE_SIZE;
-	uint32_t index = frame / FRAME_BIT;
-	uint32_t offset = frame % FRAME_BIT;
-	frames[index] |= (1 << offset);
+	bitset_set(&frames, addr / PAGE_SIZE);
 }
 
 /*
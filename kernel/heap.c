@@ -7,6 +7,7 @@
 #include "mpx/vm.h"
 #include "stdbool.h"
 #include "stdio.h"
+#include "mpx/interrupts.h"
 
 /**
  * @file heap.c
@@ -188,7 +189,13 @@ void insert_block(mem_block_t *mblock, bool list)
         mblock->next->prev = mblock;
 }
 
-void *allocate_memory(size_t size)
+/**
+ * @brief Allocates memory from the free list. The caller must keep interrupts disabled.
+ *
+ * @param size the size of the memory.
+ * @return the memory, or NULL if no block is large enough.
+ */
+static void *allocate_block(size_t size)
 {
     if(size <= 0)
         return NULL;
@@ -236,6 +243,15 @@ void *allocate_memory(size_t size)
     return (void *) walk->start_address;
 }
 
+void *allocate_memory(size_t size)
+{
+    //The timer can preempt a process halfway through relinking the lists, so keep it out.
+    unsigned int flags = irq_save();
+    void *allocated = allocate_block(size);
+    irq_restore(flags);
+    return allocated;
+}
+
 void initialize_heap(size_t size)
 {
     //Malloc the full free block.
@@ -267,11 +283,18 @@ bool block_exists(void * mcb_address)
 
 int free_memory(void * free){
     void * mcb_address =  (free - sizeof(struct mem_block));
-    if(!block_exists(mcb_address)) return -1;
+
+    unsigned int flags = irq_save();
+    if(!block_exists(mcb_address))
+    {
+        irq_restore(flags);
+        return -1;
+    }
 
     rem_mcb_free((mem_block_t *) mcb_address);
     insert_block((mem_block_t *) mcb_address, true);
     merge_blocks((mem_block_t *) mcb_address);
+    irq_restore(flags);
 
     return 0;
 }
\ No newline at end of file
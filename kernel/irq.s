@@ -1,5 +1,5 @@
 bits 32
-global rtc_isr, sys_call_isr, serial_isr
+global rtc_isr, sys_call_isr, serial_isr, timer_isr
 
 ; RTC interrupt handler
 ; Tells the slave PIC to ignore interrupts from the RTC
@@ -37,11 +37,34 @@ sys_call_isr:
 	pop es
 	pop ds
 	pop ss
-	popa
-	mov eax, 0          ; Move 0 into the EAX register to return 0.
+	popa                ; EAX holds the return value, sys_call stored it in the context.
 	sti                 ; Set the interrupts.
 	iret
 
+extern timer_isr_intern
+;;; PIT (IRQ0) interrupt handler. Saves the context exactly like sys_call_isr,
+;;; so the scheduler can switch away from the interrupted process. Every
+;;; register is restored, as the process didn't expect to be interrupted.
+timer_isr:
+    cli
+    pusha
+    push ss
+    push ds
+    push es
+    push fs
+    push gs
+    push esp
+    call timer_isr_intern   ; Returns the context to switch to
+    mov ESP, EAX
+    pop gs
+    pop fs
+    pop es
+    pop ds
+    pop ss
+    popa
+    sti
+    iret
+
 extern serial_isr_intern
 ;;; Serial port ISR. To be implemented in Module R6
 serial_isr:
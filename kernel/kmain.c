@@ -23,6 +23,7 @@
 #include <memory.h>
 #include "mpx/comhand.h"
 #include "stdlib.h"
+#include "mpx/timer.h"
 
 
 static void klogv(device dev, const char *msg)
@@ -92,13 +93,16 @@ void kmain(void)
 	klogv(COM1, "Initializing MPX modules...");
     initialize_heap(50000);
     sys_set_heap_functions(allocate_memory, free_memory);
-    generate_new_pcb("comhand", 0, SYSTEM, comhand, NULL, 0, 0);
+    generate_new_pcb("comhand", 0, SYSTEM, comhand, NULL, 0, 0, PCB_LARGE_STACK_SIZE);
     // generate_new_pcb("p1", 7, USER, proc1);
     // generate_new_pcb("p2", 3, USER, proc2);
     // generate_new_pcb("p3", 1, USER, proc3);
     // generate_new_pcb("p4", 8, USER, proc4);
     // generate_new_pcb("p4", 4, USER, proc5);
-    generate_new_pcb("idle", 9, SYSTEM, sys_idle_process, NULL, 0, 0);
+    generate_new_pcb(IDLE_PCB_NAME, 9, SYSTEM, sys_idle_process, NULL, 0, 0, PCB_SMALL_STACK_SIZE);
+
+	// Start time slicing, so a process that never idles can't starve the others.
+	timer_init(TIMER_DEFAULT_HZ, TIMER_DEFAULT_QUANTUM);
 
 	// 9) YOUR command handler -- *create and #include an appropriate .h file*
 	// Pass execution to your command handler so the user can interact with the system.
@@ -4,10 +4,51 @@
 #include "stdlib.h"
 #include "memory.h"
 #include "mpx/pcb.h"
-#include "linked_list.h"
-
-///The PCB queue for processes.
-static linked_list *running_pcb_queue;
+#include "dlist.h"
+#include "bitset.h"
+#include "hash.h"
+#include "typed_map.h"
+#include "mpx/interrupts.h"
+#include "mpx/timer.h"
+#include "mpx/sys_call.h"
+#include "mpx/cpu.h"
+
+///The index of the queue for blocked PCBs, after the ready queues.
+#define BLOCKED_QUEUE PCB_PRIORITY_LEVELS
+///The index of the queue for suspended PCBs, whether they're ready or blocked.
+#define SUSPENDED_QUEUE (PCB_PRIORITY_LEVELS + 1)
+///The index of the queue for ready real-time PCBs, ordered by deadline.
+#define REALTIME_QUEUE (PCB_PRIORITY_LEVELS + 2)
+///The amount of PCB queues.
+#define PCB_QUEUE_COUNT (PCB_PRIORITY_LEVELS + 3)
+
+///The PCB queues. The first PCB_PRIORITY_LEVELS are the FIFO ready queues for each priority.
+static dlist pcb_queues[PCB_QUEUE_COUNT];
+///If the PCB queues have been initialized.
+static bool queues_initialized = false;
+///Bit n is set while the ready queue for priority n is not empty.
+static unsigned short ready_bitmap = 0;
+///The share of the CPU reserved by real-time PCBs, in thousandths.
+static unsigned int rt_utilization = 0;
+
+///Compares PCB names.
+#define pcb_name_equals(name1, name2) (strcmp(name1, name2) == 0)
+
+DEFINE_HASH_MAP(pcb_index, const char *, struct pcb *, hash_string, pcb_name_equals)
+
+///The index from name to PCB, holding every PCB from pcb_setup until pcb_free, queued or not. Keyed by the
+///PCBs' own inline names.
+static pcb_index_t pcb_name_index = {0};
+///Exited PCBs kept for reuse, the most recently freed first. Linked through their queue nodes.
+static dlist pcb_pool;
+///The memory the pooled PCBs take up, in bytes.
+static size_t pcb_pool_bytes = 0;
+///Whether exited PCBs are pooled.
+static bool pcb_pool_enabled = true;
+///The seed shared by all PCB random streams.
+#define PCB_RAND_SEED 0x5F3759DFULL
+///The amount of PCBs created, used to give each a distinct random stream.
+static unsigned int pcb_spawn_count = 0;
 
 /**
  * @brief Gets the class name from the given enum.
@@ -84,6 +125,15 @@ void print_pcb(struct pcb *pcb_ptr)
     printf("  - Class: %s\n", get_class_name(pcb_ptr->process_class));
     printf("  - State: %s\n", get_exec_state_name(pcb_ptr->exec_state));
     printf("  - Suspended: %s\n", get_dispatch_state(pcb_ptr->dispatch_state));
+    size_t stack_used = pcb_stack_high_watermark(pcb_ptr);
+    printf("  - Stack: %u of %u bytes used at most%s\n", stack_used, pcb_ptr->stack_size,
+           stack_used == pcb_ptr->stack_size ? " (may have overflowed!)" : "");
+    if(pcb_is_realtime(pcb_ptr))
+    {
+        struct pcb_rt *rt = &pcb_ptr->rt;
+        printf("  - Real-time: %ums every %ums, %u jobs, %u missed, %u throttled\n", ticks_to_ms(rt->budget_ticks),
+               ticks_to_ms(rt->period_ticks), rt->jobs, rt->misses, rt->throttles);
+    }
 }
 
 /**
@@ -111,26 +161,176 @@ int pcb_cmpr(void *ptr1, void *ptr2)
     return pcb_ptr1->priority - pcb_ptr2->priority;
 }
 
+/**
+ * @brief Compares two PCB pointers for sorting, falling back to names when the queue order ties.
+ *
+ * @param ptr1 a pointer to the first pcb pointer.
+ * @param ptr2 a pointer to the second pcb pointer.
+ * @return the comparison value of the two pcbs.
+ */
+int pcb_sort_cmpr(const void *ptr1, const void *ptr2)
+{
+    struct pcb *pcb_ptr1 = *(struct pcb * const *) ptr1;
+    struct pcb *pcb_ptr2 = *(struct pcb * const *) ptr2;
+
+    int result = pcb_cmpr(pcb_ptr1, pcb_ptr2);
+    if(result != 0)
+        return result;
+    return strcmp(pcb_ptr1->name, pcb_ptr2->name);
+}
+
+/**
+ * @brief Packs the fields pcb_cmpr orders by into a single radix sort key.
+ *
+ * @param pcb_ptr the pcb.
+ * @return the sort key of the pcb.
+ */
+static unsigned int pcb_sort_key(const struct pcb *pcb_ptr)
+{
+    return ((unsigned int) pcb_ptr->dispatch_state << 16) | ((unsigned int) pcb_ptr->exec_state << 8) |
+           (unsigned char) pcb_ptr->priority;
+}
+
 void setup_queue()
 {
-    if(running_pcb_queue != NULL)
+    if(queues_initialized)
         return;
 
-    running_pcb_queue = nl_unbounded();
-    set_sort_func((linked_list *) running_pcb_queue, &pcb_cmpr);
+    for (int i = 0; i < PCB_QUEUE_COUNT; ++i)
+        dlist_init(&pcb_queues[i]);
+    dlist_init(&pcb_pool);
+    ready_bitmap = 0;
+    queues_initialized = true;
 }
 
-struct pcb *pcb_alloc(void)
+/**
+ * @brief Gets the amount of PCBs in all the queues.
+ * @return the amount of PCBs.
+ */
+static int pcb_queue_size(void)
+{
+    int size = 0;
+    for (int i = 0; i < PCB_QUEUE_COUNT; ++i)
+        size += pcb_queues[i].size;
+    return size;
+}
+
+/**
+ * @brief Copies the PCBs in the queue onto the end of the array. Interrupts must be disabled, so the
+ * scheduler can't move them mid-walk. Printing blocks and lets other processes run, so the queues are
+ * only ever printed from such a copy.
+ * @param index the index of the queue.
+ * @param pcbs the array.
+ * @param count the amount of PCBs already in the array.
+ * @param max the size of the array.
+ * @return the amount of PCBs in the array now.
+ */
+static int snapshot_queue(int index, struct pcb **pcbs, int count, int max)
+{
+    dlist_for_each(&pcb_queues[index], node)
+    {
+        if(count >= max)
+            break;
+        pcbs[count++] = container_of(node, struct pcb, queue_node);
+    }
+    return count;
+}
+
+/**
+ * @brief Takes a PCB with the given stack size out of the pool.
+ * @param stack_size the stack size.
+ * @return the PCB, or NULL if none in the pool has that stack size.
+ */
+static struct pcb *take_pooled_pcb(size_t stack_size)
+{
+    unsigned int flags = irq_save();
+    dlist_for_each(&pcb_pool, node)
+    {
+        struct pcb *pcb_ptr = container_of(node, struct pcb, queue_node);
+        if(pcb_ptr->stack_size == stack_size)
+        {
+            dlist_remove(&pcb_pool, node);
+            pcb_pool_bytes -= sizeof (struct pcb) + stack_size;
+            irq_restore(flags);
+            return pcb_ptr;
+        }
+    }
+    irq_restore(flags);
+    return NULL;
+}
+
+/**
+ * @brief Frees every PCB in the pool.
+ * @return true if any PCB was freed.
+ */
+static bool drain_pcb_pool(void)
+{
+    unsigned int flags = irq_save();
+    bool drained = !dlist_empty(&pcb_pool);
+    dlist_node *node;
+    while ((node = dlist_pop_front(&pcb_pool)) != NULL)
+        sys_free_mem(container_of(node, struct pcb, queue_node));
+    pcb_pool_bytes = 0;
+    irq_restore(flags);
+    return drained;
+}
+
+bool set_pcb_pool_enabled(bool enabled)
+{
+    setup_queue();
+
+    bool was_enabled = pcb_pool_enabled;
+    pcb_pool_enabled = enabled;
+    if(!enabled)
+        drain_pcb_pool();
+    return was_enabled;
+}
+
+struct pcb *pcb_alloc(size_t stack_size)
 {
     setup_queue();
 
-    struct pcb *pcb_ptr = sys_alloc_mem(sizeof (struct pcb));
-    if(pcb_ptr == NULL) return NULL;
-    memset(pcb_ptr, 0, sizeof (struct pcb));
-    pcb_ptr->stack_ptr = (void *) ((int) pcb_ptr->stack) + PCB_STACK_SIZE - 4;
+    if(stack_size == 0)
+        stack_size = PCB_STACK_SIZE;
+    if(stack_size < PCB_MIN_STACK_SIZE)
+        return NULL;
+    stack_size = (stack_size + 3) & ~(size_t) 3;
+
+    struct pcb *pcb_ptr = take_pooled_pcb(stack_size);
+    if(pcb_ptr != NULL)
+    {
+        //Only the part of the stack that was used lost the fill pattern.
+        size_t used = pcb_stack_high_watermark(pcb_ptr);
+        memset(pcb_ptr->stack + stack_size - used, PCB_STACK_FILL, used);
+    }
+    else
+    {
+        //The pool is only a cache, so it's given back before the heap runs out.
+        pcb_ptr = sys_alloc_mem(sizeof (struct pcb) + stack_size);
+        if(pcb_ptr == NULL && drain_pcb_pool())
+            pcb_ptr = sys_alloc_mem(sizeof (struct pcb) + stack_size);
+        if(pcb_ptr == NULL) return NULL;
+
+        //The fill pattern shows how deep the stack has ever been.
+        memset(pcb_ptr->stack, PCB_STACK_FILL, stack_size);
+    }
+
+    memset(pcb_ptr, 0, offsetof(struct pcb, stack));
+    pq_node_init(&pcb_ptr->sleep_node);
+    pcb_ptr->stack_size = stack_size;
+    pcb_ptr->stack_ptr = (void *) ((int) pcb_ptr->stack) + stack_size - 4;
     return pcb_ptr;
 }
 
+size_t pcb_stack_high_watermark(const struct pcb *pcb_ptr)
+{
+    //The stack grows down, so the fill pattern survives from the bottom up to the deepest point reached.
+    size_t untouched = 0;
+    while (untouched < pcb_ptr->stack_size && pcb_ptr->stack[untouched] == PCB_STACK_FILL)
+        untouched++;
+    return pcb_ptr->stack_size - untouched;
+}
+
 int pcb_free(struct pcb* pcb_ptr)
 {
     setup_queue();
@@ -138,13 +338,27 @@ int pcb_free(struct pcb* pcb_ptr)
     if(pcb_ptr == NULL)
         return 1;
 
-    if(sys_free_mem((void *) pcb_ptr->name) != 0)
-        return 1;
+    //A sleeping PCB would otherwise be woken after it's gone.
+    timer_cancel_sleep(pcb_ptr);
+
+    unsigned int flags = irq_save();
+    rt_utilization -= pcb_ptr->rt.utilization;
+    if(pcb_name_index.slots != NULL)
+        pcb_index_remove(&pcb_name_index, pcb_ptr->name, NULL);
 
-    return sys_free_mem(pcb_ptr);
+    //Keep the PCB and its stack for the next spawn if the pool has room. It's reinitialized when it's reused.
+    size_t size = sizeof (struct pcb) + pcb_ptr->stack_size;
+    bool pooled = pcb_pool_enabled && !dlist_linked(&pcb_ptr->queue_node) && pcb_pool_bytes + size <= PCB_POOL_MAX_BYTES;
+    if(pooled)
+    {
+        dlist_push_front(&pcb_pool, &pcb_ptr->queue_node);
+        pcb_pool_bytes += size;
+    }
+    irq_restore(flags);
+    return pooled ? 0 : sys_free_mem(pcb_ptr);
 }
 
-struct pcb *pcb_setup(const char *name, int class, int priority)
+struct pcb *pcb_setup(const char *name, int class, int priority, size_t stack_size)
 {
     setup_queue();
 
@@ -160,31 +374,127 @@ struct pcb *pcb_setup(const char *name, int class, int priority)
     if(priority < 0 || priority > 9)
         return NULL;
 
-    struct pcb *pcb_ptr = pcb_alloc();
+    //Names must be unique, or the index couldn't tell the PCBs apart.
+    if(pcb_find(name) != NULL)
+        return NULL;
+
+    //The index needs the heap, so it's created with the first PCB.
+    if(pcb_name_index.slots == NULL && !pcb_index_init(&pcb_name_index))
+        return NULL;
+
+    struct pcb *pcb_ptr = pcb_alloc(stack_size);
     if(pcb_ptr == NULL)
         return NULL;
 
-    //We need to malloc the string,
-    size_t str_len = strlen(name);
-    char *malloc_name = sys_alloc_mem(str_len + 1);
-    if(malloc_name == NULL)
+    //The index is keyed by the PCB's own copy of the name.
+    memcpy(pcb_ptr->name, name, strlen(name) + 1);
+    unsigned int flags = irq_save();
+    bool indexed = pcb_index_put(&pcb_name_index, pcb_ptr->name, pcb_ptr);
+    irq_restore(flags);
+
+    if(!indexed)
+    {
+        sys_free_mem(pcb_ptr);
         return NULL;
-    memcpy(malloc_name, name, str_len + 1);
+    }
 
-    pcb_ptr->name = malloc_name;
     pcb_ptr->process_class = class;
-    pcb_ptr->_item = pcb_ptr;
-    pcb_ptr->priority = priority;
+    pcb_ptr->priority = pcb_ptr->effective_priority = priority;
+    rand_stream(&pcb_ptr->rand_state, PCB_RAND_SEED, pcb_spawn_count++);
     return pcb_ptr;
 }
 
+bool pcb_is_realtime(const struct pcb *pcb_ptr)
+{
+    return pcb_ptr->rt.period_ticks != 0;
+}
+
+int pcb_rank_cmp(const struct pcb *pcb_ptr1, const struct pcb *pcb_ptr2)
+{
+    bool realtime1 = pcb_is_realtime(pcb_ptr1);
+    if(realtime1 != pcb_is_realtime(pcb_ptr2))
+        return realtime1 ? -1 : 1;
+
+    if(realtime1)
+    {
+        unsigned long long deadline1 = pcb_ptr1->rt.deadline;
+        unsigned long long deadline2 = pcb_ptr2->rt.deadline;
+        return deadline1 < deadline2 ? -1 : deadline1 > deadline2;
+    }
+    return pcb_ptr1->effective_priority - pcb_ptr2->effective_priority;
+}
+
+/**
+ * @brief Orders the real-time queue by deadline.
+ * @param node1 the first PCB's queue node.
+ * @param node2 the second PCB's queue node.
+ * @return negative if the first is due first, positive if the second is, 0 if they're due together.
+ */
+static int deadline_cmp(dlist_node *node1, dlist_node *node2)
+{
+    return pcb_rank_cmp(container_of(node1, struct pcb, queue_node), container_of(node2, struct pcb, queue_node));
+}
+
+/**
+ * @brief Releases the real-time PCB's next job once the current job's deadline has passed, refilling its budget.
+ * @param pcb_ptr the real-time PCB.
+ */
+static void release_job(struct pcb *pcb_ptr)
+{
+    struct pcb_rt *rt = &pcb_ptr->rt;
+    unsigned long long now = get_timer_ticks();
+    if(now < rt->deadline)
+        return;
+
+    rt->deadline = now + rt->period_ticks;
+    rt->budget_left = rt->budget_ticks;
+    rt->late = false;
+    rt->jobs++;
+}
+
 void pcb_insert(struct pcb* pcb_ptr)
 {
     setup_queue();
 
     if(pcb_ptr == NULL)
         return;
-    add_item(running_pcb_queue, pcb_ptr);
+
+    int index;
+    if(pcb_ptr->dispatch_state == SUSPENDED)
+    {
+        index = SUSPENDED_QUEUE;
+    }
+    else if(pcb_ptr->exec_state == BLOCKED)
+    {
+        index = BLOCKED_QUEUE;
+    }
+    else if(pcb_is_realtime(pcb_ptr))
+    {
+        index = REALTIME_QUEUE;
+    }
+    else
+    {
+        index = pcb_ptr->effective_priority;
+    }
+
+    pcb_track_state(pcb_ptr);
+
+    //The timer's scheduler uses the queues too, so they're only changed with interrupts off.
+    unsigned int flags = irq_save();
+    pcb_ptr->queue_index = index;
+    if(index == REALTIME_QUEUE)
+    {
+        //A PCB coming back after its deadline starts a new job.
+        release_job(pcb_ptr);
+        dlist_insert_sorted(&pcb_queues[index], &pcb_ptr->queue_node, &deadline_cmp);
+    }
+    else
+    {
+        if(index < PCB_PRIORITY_LEVELS)
+            ready_bitmap |= 1U << index;
+        dlist_push_back(&pcb_queues[index], &pcb_ptr->queue_node);
+    }
+    irq_restore(flags);
 }
 /**
  *
@@ -194,22 +504,12 @@ void pcb_insert(struct pcb* pcb_ptr)
  */
 struct pcb *pcb_find(const char *name)
 {
-    if(name == NULL)
-        return NULL;
-
-    setup_queue();
-
-    //Iterate over and find the item.
-    ll_node *first_node = get_first_node(running_pcb_queue);
-    while(first_node != NULL)
-    {
-        struct pcb *item_ptr = (struct pcb *) get_item_node(first_node);
-        if(strcmp(item_ptr->name, name) == 0)
-            return item_ptr;
-
-        first_node = next_node(first_node);
-    }
-    return NULL;
+    unsigned int flags = irq_save();
+    struct pcb **found = name == NULL || pcb_name_index.slots == NULL ? NULL : pcb_index_get(&pcb_name_index, name);
+    //The slot may be removed or moved as soon as interrupts are back on, so it's read before then.
+    struct pcb *pcb_ptr = found == NULL ? NULL : *found;
+    irq_restore(flags);
+    return pcb_ptr;
 }
 /**
  *
@@ -223,8 +523,21 @@ bool pcb_remove(struct pcb *pcb_ptr)
     if(pcb_ptr == NULL)
         return -1;
 
-    // get size of linked list
-    return remove_item_ptr(running_pcb_queue, pcb_ptr) == 0 ? true : false;
+    //The PCB knows its own place in the queue, so there's no need to search for it.
+    unsigned int flags = irq_save();
+    if(!dlist_linked(&pcb_ptr->queue_node))
+    {
+        irq_restore(flags);
+        return false;
+    }
+
+    //The queue is remembered, as the state or priority may have changed since the PCB was inserted.
+    int index = pcb_ptr->queue_index;
+    dlist_remove(&pcb_queues[index], &pcb_ptr->queue_node);
+    if(index < PCB_PRIORITY_LEVELS && dlist_empty(&pcb_queues[index]))
+        ready_bitmap &= ~(1U << index);
+    irq_restore(flags);
+    return true;
 }
 
 ///The label for the create label.
@@ -233,6 +546,7 @@ bool pcb_remove(struct pcb *pcb_ptr)
 #define CMD_SUSPEND_LABEL "suspend"
 #define CMD_RESUME_LABEL "resume"
 #define CMD_SETPRIORITY_LABEL "priority"
+#define CMD_REALTIME_LABEL "realtime"
 #define CMD_SHOW_LABEL "show"
 #define CMD_SHOW_READY "show-ready"
 #define CMD_SHOW_BLOCKED "show-blocked"
@@ -325,7 +639,7 @@ bool pcb_create_cmd(const char *comm)
     }
 
     //Alloc the pcb.
-    struct pcb *pcb_ptr = pcb_setup(name, class, priority);
+    struct pcb *pcb_ptr = pcb_setup(name, class, priority, 0);
     if(pcb_ptr == NULL)
     {
         println("There was an error setting up the PCB!");
@@ -382,9 +696,9 @@ bool pcb_delete_cmd(const char *comm)
         return true;
     }
 
+    printf("Removed PCB named '%s'!\n", pcb_ptr->name);
     pcb_remove(pcb_ptr);
     pcb_free(pcb_ptr);
-    printf("Removed PCB named '%s'!\n", pcb_ptr->name);
     return true;
 }
 
@@ -504,14 +818,72 @@ bool pcb_priority_cmd(const char* comm){
         println("The Number is Out of Range. Enter a Number between 0-9");
         return true;
     }
-    pcb_ptr->priority = priority;
-
-    pcb_remove(pcb_ptr);
-    pcb_insert(pcb_ptr);
+    //The running PCB isn't in a queue, and must stay out of one until it's switched away from.
+    unsigned int flags = irq_save();
+    bool queued = pcb_remove(pcb_ptr);
+    pcb_ptr->priority = pcb_ptr->effective_priority = priority;
+    if(queued)
+        pcb_insert(pcb_ptr);
+    irq_restore(flags);
 
     printf("The pcb named: %s was changed to priority %d\n", pcb_ptr->name, pcb_ptr->priority);
     return true;
 }
+/**
+ * @brief The 'realtime' sub command, reserving CPU time for a process every period.
+ * @param comm the string command.
+ * @return true if it matched, false if not.
+ */
+bool pcb_realtime_cmd(const char *comm)
+{
+    if(!first_label_matches(comm, CMD_REALTIME_LABEL))
+        return false;
+    size_t comm_strlen = strlen(comm);
+
+    char comm_cpy[comm_strlen + 1];
+    memcpy(comm_cpy, comm, comm_strlen + 1);
+    strtok(comm_cpy, " ");
+    char *name = strtok(NULL, " ");
+    char *period = strtok(NULL, " ");
+    char *budget = strtok(NULL, " ");
+    if(name == NULL || period == NULL)
+    {
+        println("Missing Arguments! Do it like this: 'pcb realtime (name) (period ms) (budget ms)' or 'pcb realtime (name) off'");
+        return true;
+    }
+
+    struct pcb *pcb_ptr = pcb_find(name);
+    if(pcb_ptr == NULL)
+    {
+        printf("PCB with name: %s, cannot be found \n", name);
+        return true;
+    }
+
+    if(strcicmp(period, "off") == 0)
+    {
+        pcb_set_realtime(pcb_ptr, 0, 0);
+        printf("The pcb named: %s is no longer real-time\n", pcb_ptr->name);
+        return true;
+    }
+
+    int period_ms = atoi(period);
+    int budget_ms = budget == NULL ? 0 : atoi(budget);
+    if(period_ms <= 0 || budget_ms <= 0 || budget_ms > period_ms)
+    {
+        println("The period and budget must be positive, with the budget no longer than the period.");
+        return true;
+    }
+
+    if(!pcb_set_realtime(pcb_ptr, period_ms, budget_ms))
+    {
+        printf("Rejected! Real-time processes may only reserve %d%% of the CPU, and %u.%u%% already is.\n",
+               RT_MAX_UTILIZATION / 10, get_rt_utilization() / 10, get_rt_utilization() % 10);
+        return true;
+    }
+
+    printf("The pcb named: %s now runs %dms every %dms\n", pcb_ptr->name, budget_ms, period_ms);
+    return true;
+}
 /**
  * @brief The 'show' sub command.
  * @param comm the string command.
@@ -555,22 +927,17 @@ bool pcb_show_ready(const char *comm)
 
     setup_queue();
 
-    //Iterate over and find the item.
-    ll_node *first_node = get_first_node(running_pcb_queue);
-    int printed = 0;
-    while(first_node != NULL)
-    {
-        struct pcb *item_ptr = (struct pcb *) get_item_node(first_node);
-        //Check if the dispatch state is equal to not suspended and the exec state is equal to ready
-        // indicating the pcb is in the ready state
-        if(item_ptr->dispatch_state == NOT_SUSPENDED && item_ptr->exec_state == READY)
-        {
-            //Print the pcb
-            print_pcb(item_ptr);
-            printed++;
-        }
-        first_node = next_node(first_node);
-    }
+    //The ready queues hold exactly the ready PCBs. Real-time PCBs run ahead of every priority, so they come first.
+    unsigned int flags = irq_save();
+    int max = pcb_queue_size();
+    struct pcb *pcbs[max + 1];
+    int printed = snapshot_queue(REALTIME_QUEUE, pcbs, 0, max);
+    for (int i = 0; i < PCB_PRIORITY_LEVELS; ++i)
+        printed = snapshot_queue(i, pcbs, printed, max);
+    irq_restore(flags);
+
+    for (int i = 0; i < printed; ++i)
+        print_pcb(pcbs[i]);
 
     if(printed == 0)
     {
@@ -591,22 +958,17 @@ bool pcb_show_blocked(const char *comm)
         return false;
     setup_queue();
 
-    //Iterate over and find the item.
-    ll_node *first_node = get_first_node(running_pcb_queue);
+    //Print the blocked PCBs, then the suspended ones.
+    unsigned int flags = irq_save();
+    int max = pcb_queue_size();
+    struct pcb *pcbs[max + 1];
     int printed = 0;
-    while(first_node != NULL)
-    {
-        struct pcb *item_ptr = (struct pcb *) get_item_node(first_node);
-        //Check if the dispatch state is equal to suspended and the exec state is equal to blocked
-        // indicating the pcb is in the blocked state
-        if(item_ptr->dispatch_state == SUSPENDED || item_ptr->exec_state == BLOCKED)
-        {
-            //Print the pcb
-            print_pcb(item_ptr);
-            printed++;
-        }
-        first_node = next_node(first_node);
-    }
+    for (int i = BLOCKED_QUEUE; i <= SUSPENDED_QUEUE; ++i)
+        printed = snapshot_queue(i, pcbs, printed, max);
+    irq_restore(flags);
+
+    for (int i = 0; i < printed; ++i)
+        print_pcb(pcbs[i]);
 
     if(printed == 0)
     {
@@ -626,28 +988,271 @@ bool pcb_show_all(const char *comm)
         return false;
     setup_queue();
 
-    //Iterate over and find the item.
-    int printed = 0;
-    ll_node *first_node = get_first_node(running_pcb_queue);
-    while(first_node != NULL)
+    //Gather the PCBs up so they can be sorted in one go.
+    unsigned int flags = irq_save();
+    int max = pcb_queue_size();
+    struct pcb *pcbs[max + 1];
+    int index = 0;
+    for (int i = 0; i < PCB_QUEUE_COUNT; ++i)
+        index = snapshot_queue(i, pcbs, index, max);
+    irq_restore(flags);
+
+    if(index == 0)
+    {
+        println("Could not find any PCBs!");
+        return true;
+    }
+
+    //The radix sort is stable, so PCBs that tie stay in queue order. Without memory for it, fall back on qsort.
+    unsigned int keys[index];
+    for (int i = 0; i < index; ++i)
+        keys[i] = pcb_sort_key(pcbs[i]);
+    if(radix_sort(keys, (void **) pcbs, index) != 0)
+        qsort(pcbs, index, sizeof(struct pcb *), &pcb_sort_cmpr);
+    for (int i = 0; i < index; ++i)
     {
-        struct pcb *item_ptr = (struct pcb *) get_item_node(first_node);
+        print_pcb(pcbs[i]);
+    }
+
+    return true;
+}
+
 
-        //Print the pcb
-        print_pcb(item_ptr);
+///The amount of times top refreshes when no count is given.
+#define TOP_DEFAULT_REFRESHES 5
+///The time between top refreshes, in milliseconds.
+#define TOP_INTERVAL_MS 1000
+///The length of a line in the top view.
+#define TOP_LINE_LEN 100
+///The amount of columns in the top view.
+#define TOP_COLUMNS 12
 
-        first_node = next_node(first_node);
-        printed++;
+///The headers of the top view's columns.
+static const char *top_headers[TOP_COLUMNS] = {
+        "NAME", "PRI", "STATE", "CPU%", "RUN(Mc)", "BLK(Mc)", "DISP", "VOL", "INV", "SYSC", "READ", "WRITE"
+};
+///The widths of the top view's columns.
+static const size_t top_widths[TOP_COLUMNS] = {10, 4, 10, 6, 9, 9, 7, 7, 7, 7, 8, 8};
+
+///A process shown by top.
+struct top_row
+{
+    ///The process.
+    struct pcb *pcb_ptr;
+    ///The cycles it ran for since the previous refresh.
+    unsigned long long cycles;
+};
+
+/**
+ * @brief Orders top rows by their CPU usage, busiest first, then by name.
+ * @param ptr1 the first row.
+ * @param ptr2 the second row.
+ * @return the comparison value of the two rows.
+ */
+static int top_row_cmpr(const void *ptr1, const void *ptr2)
+{
+    const struct top_row *row1 = ptr1;
+    const struct top_row *row2 = ptr2;
+    if(row1->cycles != row2->cycles)
+        return row1->cycles < row2->cycles ? 1 : -1;
+    return strcmp(row1->pcb_ptr->name, row2->pcb_ptr->name);
+}
+
+/**
+ * @brief Calculates what percent one cycle count is of another, without 64-bit division.
+ * @param part the part.
+ * @param total the total.
+ * @return the percentage, 0 if the total is 0.
+ */
+static unsigned int percent_of(unsigned long long part, unsigned long long total)
+{
+    while (total > 0xFFFFFFULL)
+    {
+        part >>= 1;
+        total >>= 1;
     }
+    return total == 0 ? 0 : (unsigned int) part * 100 / (unsigned int) total;
+}
 
-    if(printed == 0)
+/**
+ * @brief Appends the text to the line, padded with spaces to the column's width.
+ * @param line the line.
+ * @param pos the position in the line, moved past the column.
+ * @param text the text of the column.
+ * @param width the width of the column.
+ */
+static void append_column(char *line, size_t *pos, const char *text, size_t width)
+{
+    size_t len = strlen(text);
+    for (size_t i = 0; i < width && *pos < TOP_LINE_LEN - 1; ++i)
+        line[(*pos)++] = i < len ? text[i] : ' ';
+    line[*pos] = '\0';
+}
+
+/**
+ * @brief Clears the screen and prints one refresh of the top view.
+ */
+static void print_top(void)
+{
+    //The running process isn't in a queue, so it gets its own slot.
+    unsigned long long now = rdtsc(), total = 0;
+    unsigned int flags = irq_save();
+    struct top_row rows[pcb_queue_size() + 1];
+    int count = 0;
+    struct pcb *active = get_active_pcb();
+    for (int i = -1; i < PCB_QUEUE_COUNT; ++i)
     {
-        println("Could not find any PCBs!");
+        if(i < 0)
+        {
+            if(active != NULL)
+                rows[count++].pcb_ptr = active;
+            continue;
+        }
+        dlist_for_each(&pcb_queues[i], node)
+            rows[count++].pcb_ptr = container_of(node, struct pcb, queue_node);
     }
 
+    for (int i = 0; i < count; ++i)
+    {
+        struct pcb_stats *stats = &rows[i].pcb_ptr->stats;
+        unsigned long long run = stats->run_cycles + (rows[i].pcb_ptr == active ? now - stats->dispatched_at : 0);
+        rows[i].cycles = run - stats->top_cycles;
+        stats->top_cycles = run;
+        total += rows[i].cycles;
+    }
+    irq_restore(flags);
+
+    qsort(rows, count, sizeof(struct top_row), &top_row_cmpr);
+
+    unsigned int loads[3];
+    get_load_averages(loads);
+    clearscr();
+    printf("top - %d processes, %d runnable, load averages: %u.%02u %u.%02u %u.%02u\n\n", count, runnable_pcb_count(),
+           loads[0] / 100, loads[0] % 100, loads[1] / 100, loads[1] % 100, loads[2] / 100, loads[2] % 100);
+    char line[TOP_LINE_LEN];
+    char column[16];
+    size_t header_pos = 0;
+    for (int i = 0; i < TOP_COLUMNS; ++i)
+        append_column(line, &header_pos, top_headers[i], top_widths[i]);
+    println(line);
+
+    for (int i = 0; i < count; ++i)
+    {
+        struct pcb *pcb_ptr = rows[i].pcb_ptr;
+        struct pcb_stats *stats = &pcb_ptr->stats;
+        unsigned long long blocked = stats->blocked_cycles + (stats->blocked_at != 0 ? now - stats->blocked_at : 0);
+        unsigned int syscalls = 0;
+        for (int j = 0; j < PCB_SYSCALL_TYPES; ++j)
+            syscalls += stats->syscalls[j];
+
+        //The cycle counts are shown in units of 2^20 cycles.
+        unsigned int values[] = {
+                percent_of(rows[i].cycles, total),
+                (unsigned int) (stats->top_cycles >> 20),
+                (unsigned int) (blocked >> 20),
+                stats->dispatches,
+                stats->voluntary_switches,
+                stats->involuntary_switches,
+                syscalls,
+                stats->bytes_read,
+                stats->bytes_written,
+        };
+
+        size_t pos = 0;
+        append_column(line, &pos, pcb_ptr->name, top_widths[0]);
+        append_column(line, &pos, sprintf("%d", column, sizeof(column), pcb_ptr->priority), top_widths[1]);
+        append_column(line, &pos, pcb_ptr->dispatch_state == SUSPENDED ? "Suspended" : get_exec_state_name(pcb_ptr->exec_state), top_widths[2]);
+        for (int j = 3; j < TOP_COLUMNS; ++j)
+            append_column(line, &pos, sprintf("%u", column, sizeof(column), values[j - 3]), top_widths[j]);
+        println(line);
+    }
+}
+
+bool cmd_top(const char *comm)
+{
+    if(!first_label_matches(comm, CMD_TOP_LABEL))
+        return false;
+    setup_queue();
+
+    //Get the amount of refreshes, if given.
+    size_t str_len = strlen(comm);
+    char comm_cpy[str_len + 1];
+    memcpy(comm_cpy, comm, str_len + 1);
+    strtok(comm_cpy, " ");
+    char *count_token = strtok(NULL, " ");
+    int refreshes = count_token == NULL ? TOP_DEFAULT_REFRESHES : atoi(count_token);
+    if(refreshes <= 0)
+    {
+        println("The refresh count must be a positive number! Try 'top' or 'top (count)'");
+        return true;
+    }
+
+    for (int i = 0; i < refreshes; ++i)
+    {
+        if(i > 0)
+            sys_req(SLEEP, TOP_INTERVAL_MS);
+        print_top();
+    }
     return true;
 }
 
+/**
+ * @brief Prints how long the PCB waited in the ready queues, along with its priorities.
+ * @param pcb_ptr the PCB.
+ */
+static void print_wait_stats(struct pcb *pcb_ptr)
+{
+    struct pcb_stats *stats = &pcb_ptr->stats;
+    unsigned int average = stats->waits == 0 ? 0 : stats->total_wait_ticks / stats->waits;
+    printf("  %s: priority %d (running at %d), worst wait %ums, average wait %ums over %u dispatches\n",
+           pcb_ptr->name, pcb_ptr->priority, pcb_ptr->effective_priority,
+           ticks_to_ms(stats->max_wait_ticks), ticks_to_ms(average), stats->waits);
+}
+
+bool cmd_sched(const char *comm)
+{
+    if(!first_label_matches(comm, CMD_SCHED_LABEL))
+        return false;
+    setup_queue();
+
+    //Change the policy, if one was given.
+    size_t str_len = strlen(comm);
+    char comm_cpy[str_len + 1];
+    memcpy(comm_cpy, comm, str_len + 1);
+    strtok(comm_cpy, " ");
+    char *policy = strtok(NULL, " ");
+    if(policy != NULL)
+    {
+        if(strcicmp(policy, "strict") == 0)
+            set_sched_policy(SCHED_STRICT);
+        else if(strcicmp(policy, "fair") == 0)
+            set_sched_policy(SCHED_FAIR);
+        else
+        {
+            printf("Unknown policy '%s'! Try 'sched strict' or 'sched fair'.\n", policy);
+            return true;
+        }
+    }
+
+    printf("Scheduling policy: %s\n", get_sched_policy() == SCHED_FAIR ? "fair" : "strict");
+    printf("Real-time reservations: %u.%u%% of the CPU\n", get_rt_utilization() / 10, get_rt_utilization() % 10);
+
+    //The running process isn't in a queue, so it comes first.
+    unsigned int flags = irq_save();
+    int max = pcb_queue_size() + 1;
+    struct pcb *pcbs[max];
+    int count = 0;
+    struct pcb *active = get_active_pcb();
+    if(active != NULL)
+        pcbs[count++] = active;
+    for (int i = 0; i < PCB_QUEUE_COUNT; ++i)
+        count = snapshot_queue(i, pcbs, count, max);
+    irq_restore(flags);
+
+    for (int i = 0; i < count; ++i)
+        print_wait_stats(pcbs[i]);
+    return true;
+}
 
 ///All commands within this file, terminated with NULL.
 static bool (*command[])(const char *) = {
@@ -655,6 +1260,7 @@ static bool (*command[])(const char *) = {
         &pcb_suspend_cmd,
         &pcb_resume_cmd,
         &pcb_priority_cmd,
+        &pcb_realtime_cmd,
         &pcb_show_cmd,
         &pcb_show_ready,
         &pcb_show_blocked,
@@ -668,7 +1274,8 @@ bool generate_new_pcb(const char *name,
                       void *begin_ptr,
                       const char *input,
                       size_t input_len,
-                      size_t param_ptrs)
+                      size_t param_ptrs,
+                      size_t stack_size)
 {
     if(priority < 0 || priority > 9)
         return false;
@@ -682,7 +1289,7 @@ bool generate_new_pcb(const char *name,
         return false;
     }
 
-    struct pcb *new_pcb = pcb_setup(name, class, priority);
+    struct pcb *new_pcb = pcb_setup(name, class, priority, stack_size);
     if(new_pcb == NULL)
     {
         return false;
@@ -722,8 +1329,8 @@ bool generate_new_pcb(const char *name,
     pcb_context->es = 0x10;
     pcb_context->gs = 0x10;
     pcb_context->ss = 0x10;
-    pcb_context->ebp = (int) (new_pcb->stack + PCB_STACK_SIZE - sizeof(struct context));
-    pcb_context->esp = (int) (new_pcb->stack + PCB_STACK_SIZE - sizeof(struct context));
+    pcb_context->ebp = (int) (new_pcb->stack + new_pcb->stack_size - sizeof(struct context));
+    pcb_context->esp = (int) (new_pcb->stack + new_pcb->stack_size - sizeof(struct context));
     pcb_context->eip = (int) begin_ptr;
     pcb_context->eflags = 0x0202;
 
@@ -733,18 +1340,245 @@ bool generate_new_pcb(const char *name,
 
 struct pcb *peek_next_pcb(void)
 {
-    if(list_size(running_pcb_queue) == 0)
+    setup_queue();
+
+    //Real-time PCBs run ahead of every priority, earliest deadline first.
+    if(!dlist_empty(&pcb_queues[REALTIME_QUEUE]))
+        return dlist_entry(dlist_front(&pcb_queues[REALTIME_QUEUE]), struct pcb, queue_node);
+    if(ready_bitmap == 0)
         return NULL;
 
-    return get_item(running_pcb_queue, 0);
+    //The lowest set bit is the highest priority with a ready PCB.
+    dlist *queue = &pcb_queues[bit_scan_forward(ready_bitmap)];
+    return dlist_entry(dlist_front(queue), struct pcb, queue_node);
+}
+
+int runnable_pcb_count(void)
+{
+    setup_queue();
+
+    unsigned int flags = irq_save();
+    int count = pcb_queues[REALTIME_QUEUE].size;
+    for (int i = 0; i < PCB_PRIORITY_LEVELS; ++i)
+        count += pcb_queues[i].size;
+
+    struct pcb *active = get_active_pcb();
+    if(active != NULL)
+        count++;
+
+    //The idle process is always runnable, so counting it would say nothing.
+    struct pcb *idle = pcb_find(IDLE_PCB_NAME);
+    if(idle != NULL && (idle == active || (dlist_linked(&idle->queue_node) && idle->queue_index < PCB_PRIORITY_LEVELS)))
+        count--;
+    irq_restore(flags);
+    return count;
+}
+
+void pcb_track_state(struct pcb *pcb_ptr)
+{
+    struct pcb_stats *stats = &pcb_ptr->stats;
+    if(pcb_ptr->exec_state == BLOCKED)
+    {
+        if(stats->blocked_at == 0)
+            stats->blocked_at = rdtsc();
+    }
+    else if(stats->blocked_at != 0)
+    {
+        stats->blocked_cycles += rdtsc() - stats->blocked_at;
+        stats->blocked_at = 0;
+    }
+
+    //A wait only counts if it ends with the PCB running, not with it being suspended.
+    bool ready = pcb_ptr->exec_state == READY && pcb_ptr->dispatch_state == NOT_SUSPENDED;
+    if(ready && !stats->waiting)
+    {
+        stats->waiting = true;
+        stats->ready_tick = get_timer_ticks();
+    }
+    else if(!ready && stats->waiting)
+    {
+        stats->waiting = false;
+        if(pcb_ptr->exec_state != RUNNING)
+            return;
+
+        unsigned int wait = (unsigned int) (get_timer_ticks() - stats->ready_tick);
+        if(wait > stats->max_wait_ticks)
+            stats->max_wait_ticks = wait;
+        stats->total_wait_ticks += wait;
+        stats->waits++;
+    }
+}
+
+///The amount of ticks a PCB waits in a ready queue before fair scheduling boosts it.
+#define AGING_TICKS 10
+
+///The policy used to pick the next PCB.
+static enum sched_policy sched_policy = SCHED_STRICT;
+///The amount of ticks until the next aging pass.
+static int aging_countdown = AGING_TICKS;
+
+/**
+ * @brief Moves the PCB to a different effective priority, requeueing it if it's queued.
+ * @param pcb_ptr the PCB.
+ * @param priority the new effective priority.
+ */
+static void requeue_pcb(struct pcb *pcb_ptr, int priority)
+{
+    bool queued = pcb_remove(pcb_ptr);
+    pcb_ptr->effective_priority = priority;
+    if(queued)
+        pcb_insert(pcb_ptr);
+}
+
+void set_sched_policy(enum sched_policy policy)
+{
+    setup_queue();
+
+    unsigned int flags = irq_save();
+    sched_policy = policy;
+    if(policy == SCHED_STRICT)
+    {
+        //Every PCB goes back to its own priority.
+        struct pcb *active = get_active_pcb();
+        if(active != NULL)
+            active->effective_priority = active->priority;
+        for (int i = 0; i < PCB_QUEUE_COUNT; ++i)
+        {
+            dlist_for_each_safe(&pcb_queues[i], node, next)
+            {
+                struct pcb *pcb_ptr = container_of(node, struct pcb, queue_node);
+                if(pcb_ptr->effective_priority != pcb_ptr->priority)
+                    requeue_pcb(pcb_ptr, pcb_ptr->priority);
+            }
+        }
+    }
+    irq_restore(flags);
+}
+
+enum sched_policy get_sched_policy(void)
+{
+    return sched_policy;
+}
+
+void age_ready_pcbs(void)
+{
+    if(sched_policy != SCHED_FAIR || --aging_countdown > 0)
+        return;
+    aging_countdown = AGING_TICKS;
+    setup_queue();
+
+    //The idle process is only there for when nothing else can run, so it never ages.
+    unsigned long long now = get_timer_ticks();
+    struct pcb *idle = pcb_find(IDLE_PCB_NAME);
+    for (int i = 1; i < PCB_PRIORITY_LEVELS; ++i)
+    {
+        //Boosted PCBs move to a queue that was already visited, so they only move one level per pass.
+        dlist_for_each_safe(&pcb_queues[i], node, next)
+        {
+            struct pcb *pcb_ptr = container_of(node, struct pcb, queue_node);
+            if(pcb_ptr != idle && now - pcb_ptr->stats.ready_tick >= AGING_TICKS)
+                requeue_pcb(pcb_ptr, i - 1);
+        }
+    }
+}
+
+void decay_pcb(struct pcb *pcb_ptr)
+{
+    //Processes decay no further than the level above the idle process.
+    if(sched_policy == SCHED_FAIR && pcb_ptr->effective_priority < PCB_PRIORITY_LEVELS - 2)
+        pcb_ptr->effective_priority++;
+}
+
+bool pcb_set_realtime(struct pcb *pcb_ptr, unsigned int period_ms, unsigned int budget_ms)
+{
+    setup_queue();
+
+    unsigned int period = ms_to_ticks(period_ms);
+    unsigned int budget = period == 0 ? 0 : ms_to_ticks(budget_ms);
+    if(period != 0 && (budget == 0 || budget > period))
+        return false;
+
+    //Scaled down so the multiplication can't overflow, the budget is never more than the period.
+    unsigned int scaled_period = period, scaled_budget = budget;
+    while (scaled_period > 0x3FFFFF)
+    {
+        scaled_period >>= 1;
+        scaled_budget >>= 1;
+    }
+    unsigned int utilization = period == 0 ? 0 : scaled_budget * 1000 / scaled_period;
+
+    //Admission control, the reservations must leave the rest of the CPU to the priority queues.
+    unsigned int flags = irq_save();
+    unsigned int reserved = rt_utilization - pcb_ptr->rt.utilization;
+    if(reserved + utilization > RT_MAX_UTILIZATION)
+    {
+        irq_restore(flags);
+        return false;
+    }
+    rt_utilization = reserved + utilization;
+
+    //The PCB changes queues, and its first job is released right away.
+    bool queued = pcb_remove(pcb_ptr);
+    struct pcb_rt *rt = &pcb_ptr->rt;
+    rt->period_ticks = period;
+    rt->budget_ticks = budget;
+    rt->utilization = utilization;
+    rt->deadline = 0;
+    if(period != 0)
+        release_job(pcb_ptr);
+    if(queued)
+        pcb_insert(pcb_ptr);
+    irq_restore(flags);
+    return true;
+}
+
+unsigned int get_rt_utilization(void)
+{
+    return rt_utilization;
+}
+
+bool charge_realtime(struct pcb *pcb_ptr)
+{
+    if(!pcb_is_realtime(pcb_ptr))
+        return false;
+
+    struct pcb_rt *rt = &pcb_ptr->rt;
+    if(!rt->late && get_timer_ticks() >= rt->deadline)
+    {
+        rt->late = true;
+        rt->misses++;
+    }
+
+    if(rt->budget_left > 1)
+    {
+        rt->budget_left--;
+        return false;
+    }
+    rt->budget_left = 0;
+    rt->throttles++;
+    return true;
 }
 
 struct pcb *poll_next_pcb(void)
 {
-    if(list_size(running_pcb_queue) == 0)
-        return NULL;
+    unsigned int flags = irq_save();
+    struct pcb *pcb_ptr = peek_next_pcb();
+    if(pcb_ptr != NULL)
+        pcb_remove(pcb_ptr);
+    irq_restore(flags);
+    return pcb_ptr;
+}
 
-    return remove_item_unsafe(running_pcb_queue, 0);
+void clear_pcb_queues(void)
+{
+    setup_queue();
+    unsigned int flags = irq_save();
+    for (int i = 0; i < PCB_QUEUE_COUNT; ++i)
+    {
+        while(dlist_pop_front(&pcb_queues[i]) != NULL);
+    }
+    ready_bitmap = 0;
+    irq_restore(flags);
 }
 
 void exec_pcb_cmd(const char *comm)
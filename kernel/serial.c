@@ -4,15 +4,18 @@
 #include "string.h"
 #include "stdio.h"
 #include "ctype.h"
-#include "linked_list.h"
+#include "dlist.h"
+#include "bitset.h"
+#include "deque.h"
 #include "memory.h"
 #include "commands.h"
 #include "color.h"
 #include "mpx/interrupts.h"
+#include "mpx/timer.h"
 #include "sys_req.h"
 #include "cli.h"
 #include "commands.h"
-#define RING_BUFFER_LEN 150
+#define RING_BUFFER_LEN 128
 
 #define ERROR_101 "invalid (null) event flag pointer"
 #define ERROR_102 "Invalid baud rate divisor"
@@ -160,15 +163,12 @@ int serial_out(device dev, const char *buffer, size_t len)
 
 #define ANSI_CODE_READ_LEN 15
 #define MAX_CLI_HISTORY_LEN (5)
+///The capacity of the CLI history ring, a power of two holding at least MAX_CLI_HISTORY_LEN lines.
+#define CLI_HISTORY_RING_LEN 8
 
 ///Used to store a specific line previously entered.
 struct line_entry
 {
-    ///These are a hacky way to use linked lists without excessive allocation (temp until R5)
-    void *_dont_use_1;
-    ///These are a hacky way to use linked lists without excessive allocation (temp until R5)
-    void *_dont_use_2;
-
     /**
      * The line that was entered. Does not include null terminator.
      */
@@ -210,6 +210,25 @@ static bool cli_invisible = false;
 static bool tab_completions = false;
 ///The prompt to print when requesting input.
 static const char *prompt = NULL;
+///The color commands that exist are echoed in, looked up on first use.
+static const color_t *cmd_exists_color = NULL;
+///The color commands that don't exist are echoed in, looked up on first use.
+static const color_t *cmd_unknown_color = NULL;
+
+/**
+ * @brief Gets the color a command is echoed in. The colors are looked up once rather than on every keystroke.
+ * @param cmd_exists if the command exists.
+ * @return the color.
+ */
+static const color_t *command_color(bool cmd_exists)
+{
+    if(cmd_exists_color == NULL)
+    {
+        cmd_exists_color = get_color("bright-green");
+        cmd_unknown_color = get_color("red");
+    }
+    return cmd_exists ? cmd_exists_color : cmd_unknown_color;
+}
 
 /**
  * @brief Sets the output color using serial_out instead of printf. (Avoids sys_req call)
@@ -337,6 +356,8 @@ typedef struct {
     bool allocated;
     ///The operation this device is currently doing.
     dcb_status_t operation;
+    ///The last operation started on this device, kept after it finishes.
+    dcb_status_t last_operation;
     ///Whether or not there is an event to be handled.
     bool event;
     ///The PCB currently using this DCB.
@@ -353,22 +374,18 @@ typedef struct {
     char escape_buffer[6];
     ///The position in the escape buffer.
     int escape_buf_pos;
-    ///The total length of the ring buffer.
-    size_t r_buffer_len;
-    ///The current size of the ring buffer.
-    size_t r_buffer_size;
-    ///The beginning of the ring buffer.
-    char *r_buffer_start;
-    ///The read index for the ring buffer.
-    int read_index;
-    ///The write index for the ring buffer.
-    int write_index;
-    ///This list contains all pending operations.
-    linked_list *pending_iocb;
+    ///The ring buffer holding characters typed while nothing is reading.
+    deque_t r_buffer;
+    ///The memory backing the ring buffer.
+    char r_buffer_data[RING_BUFFER_LEN];
+    ///This list contains all pending operations, oldest first.
+    dlist pending_iocb;
 } dcb_t;
 
 ///A descriptor for pending IO operations.
 typedef struct {
+    ///The link into the device's pending list.
+    dlist_node node;
     ///A pointer to the device this IOCB belongs to.
     dcb_t *device;
     ///A pointer to the process this IOCB belongs to.
@@ -389,6 +406,29 @@ static dcb_t device_controllers[4] = {
         {.dev = COM4}
 };
 
+///One bit per DCB, set once the DCB's IO operation completes, so the scheduler finds it without scanning the devices.
+static volatile unsigned int completion_bitmap = 0;
+
+/**
+ * @brief Marks the DCB's IO operation as completed, so its PCB is loaded by check_completed.
+ * @param dcb the device control block.
+ */
+static void signal_completion(dcb_t *dcb)
+{
+    dcb->event = true;
+    completion_bitmap |= 1U << (dcb - device_controllers);
+}
+
+/**
+ * @brief Clears the DCB's completed IO operation.
+ * @param dcb the device control block.
+ */
+static void clear_completion(dcb_t *dcb)
+{
+    dcb->event = false;
+    completion_bitmap &= ~(1U << (dcb - device_controllers));
+}
+
 /**
  * @brief Checks if the given character is a new line character.
  *
@@ -519,14 +559,7 @@ void echo_line(char *line, dcb_t *dcb, int line_pos_beginning)
     if(command_formatting_enabled)
     {
         cmd_exists = command_exists(dcb->io_buffer);
-        if(cmd_exists)
-        {
-            internal_soc(get_color("bright-green"));
-        }
-        else
-        {
-            internal_soc(get_color("red"));
-        }
+        internal_soc(command_color(cmd_exists));
     }
 
     serial_out(dcb->dev, line, dcb->io_bytes);
@@ -555,13 +588,8 @@ int input_isr(dcb_t *dcb)
     char read = inb(dcb->dev);
     if(dcb->operation != READING)
     {
-        //Full? Discard the thing then.
-        if(dcb->r_buffer_len == dcb->r_buffer_size)
-            return 0;
-
-        dcb->r_buffer_start[dcb->write_index] = read;
-        dcb->write_index = (dcb->write_index + 1) % (int) dcb->r_buffer_len;
-        dcb->r_buffer_size++;
+        //Full? The deque discards the thing then.
+        deque_push_back(&dcb->r_buffer, &read);
         return 0;
     }
 
@@ -569,7 +597,7 @@ int input_isr(dcb_t *dcb)
     {
         outb(dcb->dev, '\n');
         dcb->operation = IDLING;
-        dcb->event = true;
+        signal_completion(dcb);
         return 0;
     }
 
@@ -582,7 +610,7 @@ int input_isr(dcb_t *dcb)
         return 0;
 
     dcb->operation = IDLING;
-    dcb->event = true;
+    signal_completion(dcb);
     return (int) dcb->io_bytes;
 }
 
@@ -598,46 +626,61 @@ int output_isr(dcb_t *dcb)
         return 0;
     }
 
-    dcb->event = true;
+    signal_completion(dcb);
     dcb->operation = IDLING;
     return (int) dcb->io_requested;
 }
 
+bool io_completion_pending(void)
+{
+    return completion_bitmap != 0;
+}
+
 struct pcb *check_completed(void)
 {
-    //Look for DCBs that were using this PCB.
-    for (int i = 0; i < 4; ++i)
+    //Only DCBs whose operation completed have their bit set, the lowest one is handled first.
+    while (completion_bitmap != 0)
     {
-        dcb_t *dcb = device_controllers + i;
+        int index = bit_scan_forward(completion_bitmap);
+        dcb_t *dcb = device_controllers + index;
         struct pcb *active_pcb = dcb->pcb;
-        if(!dcb->event || active_pcb == NULL) //This signifies being done, or no activity at all.
+        if(active_pcb == NULL) //Nobody is waiting on the operation.
+        {
+            completion_bitmap &= ~(1U << index);
             continue;
+        }
+
+        //sys_req returns the byte count, which is the EAX the PCB was saved with.
+        ((struct context *) active_pcb->stack_ptr)->eax = (int) dcb->io_bytes;
+        if(dcb->last_operation == READING)
+            active_pcb->stats.bytes_read += dcb->io_bytes;
+        else
+            active_pcb->stats.bytes_written += dcb->io_bytes;
 
         //Check for a pending io operation.
-        if(list_size(dcb->pending_iocb) == 0)
+        if(dlist_empty(&dcb->pending_iocb))
         {
-            dcb->event = false;
+            clear_completion(dcb);
             dcb->pcb = NULL;
             return active_pcb;
         }
 
-        iocb_t *iocb = (iocb_t *) remove_item_unsafe(dcb->pending_iocb, 0);
+        iocb_t *iocb = container_of(dlist_pop_front(&dcb->pending_iocb), iocb_t, node);
 
-        int bytes_transferred = -1;
+        //Start the next operation. Its own completion sets the bit again.
+        dcb->pcb = iocb->pcb;
         if(iocb->operation == READING)
-            bytes_transferred = serial_read(dcb->dev, iocb->buffer, iocb->buf_len);
+            serial_read(dcb->dev, iocb->buffer, iocb->buf_len);
         else
-            bytes_transferred = serial_write(dcb->dev, iocb->buffer, iocb->buf_len);
+            serial_write(dcb->dev, iocb->buffer, iocb->buf_len);
 
-        dcb->pcb = iocb->pcb;
-        (void) bytes_transferred;
         sys_free_mem(iocb);
         return active_pcb; // This is the PCB that needs to now run as its operation was completed.
     }
     return NULL;
 }
 
-io_req_result io_request(struct pcb *pcb, op_code operation, device dev, char *buffer, size_t length)
+io_req_result io_request(struct pcb *pcb, op_code operation, device dev, char *buffer, size_t length, size_t *transferred)
 {
     int dcb_ind = serial_devno(dev);
     if(dcb_ind == -1)
@@ -653,10 +696,13 @@ io_req_result io_request(struct pcb *pcb, op_code operation, device dev, char *b
     if(!dcb->allocated)
         return DEVICE_CLOSED;
 
-    if(dcb->operation != IDLING)
+    //A finished operation whose PCB wasn't loaded yet still owns the device.
+    if(dcb->operation != IDLING || (dcb->event && dcb->pcb != NULL))
     {
         //Create an IOCB and add it to the pending list.
         iocb_t *iocb = sys_alloc_mem(sizeof (iocb_t));
+        if(iocb == NULL)
+            return DEVICE_BUSY;
         memset(iocb, 0, sizeof (iocb_t));
         iocb->buf_len = length;
         iocb->buffer = buffer;
@@ -664,22 +710,27 @@ io_req_result io_request(struct pcb *pcb, op_code operation, device dev, char *b
         iocb->operation = operation == WRITE ? WRITING : READING;
         iocb->pcb = pcb;
 
-        add_item(dcb->pending_iocb, iocb);
+        dlist_push_back(&dcb->pending_iocb, &iocb->node);
         return DEVICE_BUSY;
     }
 
     dcb->pcb = pcb;
-    if(operation == READ)
-    {
-        int read = serial_read(dev, buffer, length);
-        return read < (int) length ? PARTIALLY_SERVICED : SERVICED;
-    }
-    else if(operation == WRITE)
+    int result = operation == READ ? serial_read(dev, buffer, length) : serial_write(dev, buffer, length);
+    if(result < 0)
     {
-        int written = serial_write(dev, buffer, length);
-        return written < (int) length ? PARTIALLY_SERVICED : SERVICED;
+        dcb->pcb = NULL;
+        return INVALID_PARAMS;
     }
-    return -1; //Should never happen.
+
+    //Still going, the PCB has to wait for the ISR to finish it.
+    if(dcb->operation != IDLING)
+        return PARTIALLY_SERVICED;
+
+    //Done already, so there's no completion for check_completed to hand out.
+    clear_completion(dcb);
+    dcb->pcb = NULL;
+    *transferred = (size_t) result;
+    return SERVICED;
 }
 
 extern void serial_isr(void*);
@@ -765,13 +816,10 @@ int serial_open(device dev, int speed)
 
     dcb->dev = dev;
     dcb->allocated = true;
-    dcb->event = false;
+    clear_completion(dcb);
     dcb->operation = IDLING;
-    dcb->r_buffer_len = RING_BUFFER_LEN;
-    dcb->r_buffer_size = 0;
-    dcb->r_buffer_start = sys_alloc_mem(RING_BUFFER_LEN);
-    dcb->read_index = dcb->write_index = 0;
-    dcb->pending_iocb = nl_unbounded();
+    deque_init_buffer(&dcb->r_buffer, dcb->r_buffer_data, sizeof (char), RING_BUFFER_LEN, false);
+    dlist_init(&dcb->pending_iocb);
 
     int com_irq = find_com_irq(dev);
     int com_iv = find_com_iv(dev);
@@ -808,7 +856,13 @@ int serial_close(device dev)
     if(!dcb->allocated)
         return code_selection(-201); //Throw Error Serial port not open
 
-    destroy_list(dcb->pending_iocb, true);
+    dlist_for_each_safe(&dcb->pending_iocb, node, next)
+    {
+        dlist_remove(&dcb->pending_iocb, node);
+        sys_free_mem(container_of(node, iocb_t, node));
+    }
+    deque_clear(&dcb->r_buffer);
+    clear_completion(dcb);
     dcb->allocated = 0;
     cli();
     int mask = inb(0x21);
@@ -845,23 +899,20 @@ int serial_read(device dev, char *buf, size_t len)
         return code_selection(-304);
 
     //Initialize values for reading, but not the ring buffer
-    dcb->event = false;
+    clear_completion(dcb);
     dcb->io_buffer = buf;
     dcb->io_bytes = dcb->line_pos = 0;
     dcb->io_requested = len;
     // setting status to 'reading'
-    dcb->operation = READING;
+    dcb->operation = dcb->last_operation = READING;
     
     //Read all available things from ring buffer.
-    while(dcb->r_buffer_size > 0 &&
-          dcb->io_bytes < dcb->io_requested &&
-          !is_newline(dcb->io_buffer[dcb->io_bytes]))
+    char read;
+    while(dcb->io_bytes < dcb->io_requested &&
+          !is_newline(dcb->io_buffer[dcb->io_bytes]) &&
+          deque_pop_front(&dcb->r_buffer, &read))
     {
-        char read = dcb->r_buffer_start[dcb->read_index];
-        dcb->read_index = (dcb->read_index + 1) % RING_BUFFER_LEN;
-
         handle_new_char(read, dcb);
-        dcb->r_buffer_size--;
     }
 
     if(dcb->io_bytes > 0)
@@ -871,7 +922,7 @@ int serial_read(device dev, char *buf, size_t len)
     if(dcb->io_bytes == dcb->io_requested || is_newline(dcb->io_buffer[dcb->io_bytes]))
     {
         dcb->operation = IDLING;
-        dcb->event = true;
+        signal_completion(dcb);
         return (int) dcb->io_bytes;
     }
 
@@ -906,8 +957,8 @@ int serial_write(device dev, char *buf, size_t len)
     dcb->io_buffer = buf;
     dcb->io_bytes = 1;
     dcb->io_requested = len;
-    dcb->event = false;
-    dcb->operation = WRITING;
+    clear_completion(dcb);
+    dcb->operation = dcb->last_operation = WRITING;
    
     // get first character from request buff and store it in output register
     outb(dev, buf[0]);
@@ -918,23 +969,16 @@ int serial_write(device dev, char *buf, size_t len)
     return 0;
 }
 
-///The CLI history from the serial_poll function.
-static linked_list *cli_history = NULL;
+///The memory backing the CLI history.
+static struct line_entry cli_history_data[CLI_HISTORY_RING_LEN];
+///The CLI history from the serial_poll function, oldest first.
+static deque_t cli_history = {0};
 
 int serial_poll(device dev, char *buffer, size_t len)
 {
-    if (cli_history == NULL && cli_history_enabled)
-    {
-        cli_history = nl_unbounded();
-    }
-
-    //Check if the CLI should be forcefully disabled.
-    if(cli_history_enabled && list_size(cli_history) > MAX_CLI_HISTORY_LEN)
+    if (cli_history.data == NULL)
     {
-        //Free the oldest CLI history object.
-        struct line_entry *item = remove_item_unsafe(cli_history, 0);
-        sys_free_mem(item->line);
-        sys_free_mem(item);
+        deque_init_buffer(&cli_history, cli_history_data, sizeof(struct line_entry), CLI_HISTORY_RING_LEN, false);
     }
 
     //Keeps track of the current line entry. Used when command line
@@ -946,8 +990,8 @@ int serial_poll(device dev, char *buffer, size_t len)
             .line_length = len
     };
 
-    int cli_index = cli_history != NULL && cli_history_enabled
-            ? list_size(cli_history) : 0;
+    //The history entry being shown, the history's size is the line being typed.
+    int cli_index = (int) cli_history.size;
     size_t bytes_read = 0;
     int line_pos = 0;
 
@@ -964,6 +1008,10 @@ int serial_poll(device dev, char *buffer, size_t len)
         {
             if(buffer == NULL)
                 return 0;
+
+            //Sleep until the next interrupt instead of spinning, the timer guarantees one comes.
+            if(get_timer_frequency() != 0 && interrupts_enabled())
+                hlt();
             continue;
         }
 
@@ -1094,9 +1142,9 @@ int serial_poll(device dev, char *buffer, size_t len)
                     if(!cli_history_enabled)
                         continue;
 
-                    int l_size = list_size(cli_history);
+                    int l_size = (int) cli_history.size;
                     //Check if we can move in the history.
-                    if (cli_history == NULL || (cli_index <= 0 && action_arr[0] == 'A')
+                    if ((cli_index <= 0 && action_arr[0] == 'A')
                         || (cli_index >= l_size && action_arr[0] == 'B'))
                         continue;
 
@@ -1105,7 +1153,7 @@ int serial_poll(device dev, char *buffer, size_t len)
                     cli_index += delta;
                     struct line_entry *l_entry = cli_index >= l_size ?
                                                  &current_entry :
-                                                 get_item(cli_history, cli_index);
+                                                 deque_at(&cli_history, cli_index);
                     size_t copy_len = l_entry->line_length > len
                                       ? len :
                                       l_entry->line_length;
@@ -1215,14 +1263,7 @@ int serial_poll(device dev, char *buffer, size_t len)
         if(command_formatting_enabled)
         {
             cmd_exists = command_exists(buffer);
-            if(cmd_exists)
-            {
-                internal_soc(get_color("bright-green"));
-            }
-            else
-            {
-                internal_soc(get_color("red"));
-            }
+            internal_soc(command_color(cmd_exists));
         }
 
         serial_out(dev, buffer, bytes_read);
@@ -1241,16 +1282,24 @@ int serial_poll(device dev, char *buffer, size_t len)
     }
 
     //Allocate the line for storage.
-    if (cli_history != NULL && cli_history_enabled)
+    if (cli_history_enabled)
     {
+        //Free the oldest CLI history line once full.
+        struct line_entry oldest;
+        if (cli_history.size >= MAX_CLI_HISTORY_LEN && deque_pop_front(&cli_history, &oldest))
+            sys_free_mem(oldest.line);
+
         //Allocate memory and store string.
-        struct line_entry *to_store = sys_alloc_mem(sizeof(struct line_entry));
         char *store_line = sys_alloc_mem(bytes_read);
-        memcpy(store_line, buffer, bytes_read);
-
-        to_store->line = store_line;
-        to_store->line_length = bytes_read;
-        add_item_index(cli_history, list_size(cli_history), to_store);
+        if (store_line != NULL)
+        {
+            memcpy(store_line, buffer, bytes_read);
+            struct line_entry to_store = {
+                    .line = store_line,
+                    .line_length = bytes_read
+            };
+            deque_push_back(&cli_history, &to_store);
+        }
     }
     serial_out(dev, "\n", 1);
     return (int) bytes_read;
@@ -3,6 +3,10 @@
 #include "linked_list.h"
 #include "mpx/device.h"
 #include "mpx/serial.h"
+#include "mpx/sys_call.h"
+#include "mpx/timer.h"
+#include "mpx/interrupts.h"
+#include "mpx/cpu.h"
 
 /**
  * @file sys_call.c
@@ -13,11 +17,13 @@
 static struct pcb *active_pcb_ptr = NULL;
 ///The first context saved when sys_call is called.
 static struct context *first_context_ptr = NULL;
+///Whether the running PCB is being switched out by the timer, rather than giving up the CPU itself.
+static bool preempting = false;
 
 /**
  * @brief Gets the next PCB to replace the current one. The PCB can be sourced from one of two locations. They're listed in the order they're checked.
  * 1. The DCB queues. If a process is loaded from there, it means that its IO operation was finished.
- * 2. The PCB queue. If no such PCB is done in the DCBs, a PCB is polled from the PCB queue. If no PCB is available, NULL returns.
+ * 2. The ready queues. If no such PCB is done in the DCBs, the highest priority ready PCB is polled. If no PCB is ready, NULL returns.
  * In either case, the PCB is prepared for running by removing it from wherever it is in the PCB queue and set to a 'RUNNING' state.
  *
  * @return the next PCB to load, or NULL if no such PCB exists.
@@ -42,12 +48,11 @@ struct pcb *get_next_pcb()
         }
     }
 
-    //Otherwise, load one from the PCB queues.
-    struct pcb *queue_pcb = peek_next_pcb();
-    if(queue_pcb == NULL || queue_pcb->exec_state == BLOCKED || queue_pcb->dispatch_state == SUSPENDED)
+    //Otherwise, load one from the ready queues. Blocked and suspended PCBs are never in them.
+    struct pcb *queue_pcb = poll_next_pcb();
+    if(queue_pcb == NULL)
         return NULL;
 
-    poll_next_pcb();
     queue_pcb->exec_state = RUNNING;
     return queue_pcb;
 }
@@ -67,10 +72,27 @@ struct context *next_pcb(struct pcb *next_pcb, struct context *current_context,
 
     struct pcb *present_pcb = active_pcb_ptr;
     active_pcb_ptr = next_pcb;
+    set_rand_state(&next_pcb->rand_state);
+    reset_time_quantum();
+
+    unsigned long long now = rdtsc();
+    next_pcb->stats.dispatches++;
+    next_pcb->stats.dispatched_at = now;
+    pcb_track_state(next_pcb);
+
     struct context *new_ctx = (struct context *) next_pcb->stack_ptr;
     //Checks to see if the active pointer pcb is null
     if (present_pcb != NULL && current_context != NULL)
     {
+        present_pcb->stats.run_cycles += now - present_pcb->stats.dispatched_at;
+        if(preempting)
+            present_pcb->stats.involuntary_switches++;
+        else
+            present_pcb->stats.voluntary_switches++;
+
+        //Processes that block for IO or sleep aren't hogging the CPU, so they get their own priority back.
+        if(next_state == BLOCKED)
+            present_pcb->effective_priority = present_pcb->priority;
         present_pcb->exec_state = next_state;
         pcb_insert(present_pcb);
         //Update where the PCB's context pointer is pointing.
@@ -93,54 +115,77 @@ struct context *sys_call(op_code action, struct context *ctx)
         first_context_ptr = ctx;
     }
 
-    int ebx = 0, ecx = 0, edx = 0;
-    __asm__ volatile("mov %%ebx,%0" : "=r"(ebx));
-    __asm__ volatile("mov %%ecx,%0" : "=r"(ecx));
-    __asm__ volatile("mov %%edx,%0" : "=r"(edx));
+    //sys_req returns whatever is left in the context's EAX, 0 unless the operation says otherwise.
+    ctx->eax = 0;
+    if(active_pcb_ptr != NULL && action < PCB_SYSCALL_TYPES)
+        active_pcb_ptr->stats.syscalls[action]++;
 
-    //Handle different actions in their own way.
-    struct pcb *next_to_load = get_next_pcb();
+    //Handle different actions in their own way. The scheduler is only consulted when the caller gives up the CPU.
     switch (action)
     {
         case READ:
-        {
-            device dev = (device) ebx;
-            char *buffer = (char *) ecx;
-            size_t bytes = (size_t) edx;
-            io_req_result result = io_request(active_pcb_ptr, action, dev, buffer, bytes);
-
-            if (result == INVALID_PARAMS || result == SERVICED)
-                return next_pcb(next_to_load, ctx, READY);
-
-            //In this case, we need to move this device to a blocked state and CTX switch.
-            if (result == PARTIALLY_SERVICED || result == DEVICE_BUSY)
-            {
-                return next_pcb(next_to_load, ctx, BLOCKED);
-            }
-            return ctx;
-        }
         case WRITE:
         {
-            device dev = (device) ebx;
-            char *buffer = (char *) ecx;
-            size_t bytes = (size_t) edx;
-            io_req_result result = io_request(active_pcb_ptr, action, dev, buffer, bytes);
+            //The parameters were saved into the context by sys_call_isr.
+            device dev = (device) ctx->ebx;
+            char *buffer = (char *) ctx->ecx;
+            size_t bytes = (size_t) ctx->edx;
+            size_t transferred = 0;
+            io_req_result result = io_request(active_pcb_ptr, action, dev, buffer, bytes, &transferred);
 
-            if (result == INVALID_PARAMS || result == SERVICED)
+            //Fast path, the operation is done so the caller simply keeps running.
+            if (result == SERVICED)
             {
-                return next_pcb(next_to_load, ctx, READY);
+                if(active_pcb_ptr != NULL && action == READ)
+                    active_pcb_ptr->stats.bytes_read += transferred;
+                else if(active_pcb_ptr != NULL)
+                    active_pcb_ptr->stats.bytes_written += transferred;
+                ctx->eax = (int) transferred;
+                return ctx;
             }
 
             //In this case, we need to move this device to a blocked state and CTX switch.
             if (result == PARTIALLY_SERVICED || result == DEVICE_BUSY)
             {
-                return next_pcb(next_to_load, ctx, BLOCKED);
+                return next_pcb(get_next_pcb(), ctx, BLOCKED);
             }
             return ctx;
         }
         case IDLE:
         {
-            return next_pcb(next_to_load, ctx, READY);
+            return next_pcb(get_next_pcb(), ctx, READY);
+        }
+        case SLEEP:
+        case SLEEP_UNTIL:
+        {
+            //SLEEP passes milliseconds in EBX, SLEEP_UNTIL a tick split over EBX and ECX.
+            unsigned long long now = get_timer_ticks();
+            unsigned long long wake_tick = action == SLEEP
+                    ? now + ms_to_ticks((unsigned int) ctx->ebx)
+                    : ((unsigned long long) (unsigned int) ctx->ecx << 32) | (unsigned int) ctx->ebx;
+
+            //Nothing to wait for, so it's just a yield.
+            if(active_pcb_ptr == NULL || wake_tick <= now)
+                return next_pcb(get_next_pcb(), ctx, READY);
+
+            struct pcb *sleeper = active_pcb_ptr;
+            if(!timer_sleep(sleeper, wake_tick))
+                return next_pcb(get_next_pcb(), ctx, READY);
+
+            //With nothing else to run, halt here until a sleeper wakes up or an IO operation finishes.
+            struct pcb *next_to_load;
+            while ((next_to_load = get_next_pcb()) == NULL)
+                timer_idle(next_wake_tick());
+            if(next_to_load == sleeper)
+                return ctx;
+
+            //The sleeper may have woken while halted, in which case it's already in a ready queue.
+            if(!pq_queued(&sleeper->sleep_node))
+            {
+                pcb_remove(sleeper);
+                return next_pcb(next_to_load, ctx, READY);
+            }
+            return next_pcb(next_to_load, ctx, BLOCKED);
         }
         case EXIT:
         {
@@ -150,14 +195,71 @@ struct context *sys_call(op_code action, struct context *ctx)
                 return ctx;
 
             pcb_remove(exiting_pcb);
+            struct pcb *next_to_load = get_next_pcb();
             if (next_to_load == NULL) //No next process to load? Try loading the global one.
+            {
+                active_pcb_ptr = NULL;
+                set_rand_state(NULL);
                 return first_context_ptr;
+            }
 
             //Free the old one.
             pcb_free(exiting_pcb);
             return next_pcb(next_to_load, NULL, 0);
         }
         default:
-            return next_pcb(next_to_load, ctx, READY);
+            return next_pcb(get_next_pcb(), ctx, READY);
     }
-}
\ No newline at end of file
+}
+
+struct context *preempt_pcb(struct context *ctx)
+{
+    //Only processes are preempted, never the kernel before the first dispatch or after the last exit.
+    if(active_pcb_ptr == NULL)
+        return ctx;
+
+    //Lower priority processes keep waiting, unless an IO operation has finished.
+    struct pcb *ready = peek_next_pcb();
+    if(!io_completion_pending() && (ready == NULL || pcb_rank_cmp(ready, active_pcb_ptr) > 0))
+        return ctx;
+
+    preempting = true;
+    struct context *next_ctx = next_pcb(get_next_pcb(), ctx, READY);
+    preempting = false;
+    return next_ctx;
+}
+
+struct context *throttle_pcb(struct context *ctx)
+{
+    struct pcb *throttled = active_pcb_ptr;
+    if(throttled == NULL)
+        return ctx;
+
+    struct pcb *next_to_load = get_next_pcb();
+    if(next_to_load == NULL)
+        return ctx;
+
+    //Past its deadline there's nothing to wait for, being queued again releases the next job.
+    enum pcb_exec_state next_state = READY;
+    if(throttled->rt.deadline > get_timer_ticks() && timer_sleep(throttled, throttled->rt.deadline))
+        next_state = BLOCKED;
+
+    preempting = true;
+    struct context *next_ctx = next_pcb(next_to_load, ctx, next_state);
+    preempting = false;
+    return next_ctx;
+}
+
+void cpu_idle(void)
+{
+    //Checked with interrupts off, so work that arrives afterwards still wakes the halt.
+    unsigned int flags = irq_save();
+    if(peek_next_pcb() == NULL && !io_completion_pending())
+        timer_idle(next_wake_tick());
+    irq_restore(flags);
+}
+
+struct pcb *get_active_pcb(void)
+{
+    return active_pcb_ptr;
+}
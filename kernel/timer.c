@@ -0,0 +1,333 @@
+#include "mpx/timer.h"
+#include "mpx/sys_call.h"
+#include "mpx/interrupts.h"
+#include "mpx/io.h"
+#include "pqueue.h"
+
+/**
+ * @file timer.c
+ * @brief The driver for channel 0 of the programmable interval timer. Every tick counts down the running
+ * process' quantum, and once it runs out the scheduler gets a chance to switch processes.
+ */
+
+///The PIT's channel 0 data port.
+#define PIT_CHANNEL0 0x40
+///The PIT's mode/command port.
+#define PIT_COMMAND 0x43
+///Channel 0, low then high byte of the divisor, mode 2 (rate generator), binary.
+#define PIT_RATE_GENERATOR 0x34
+///Channel 0, low then high byte of the count, mode 0 (interrupt on terminal count), binary.
+#define PIT_ONE_SHOT 0x30
+///Latches channel 0's current count, so it can be read.
+#define PIT_LATCH 0x00
+///The largest count the PIT can be programmed with, about 55 milliseconds.
+#define PIT_MAX_COUNT 0xFFFF
+///The amount of fractional bits in the load averages.
+#define LOAD_SHIFT 11
+///1.0 as a load average.
+#define LOAD_ONE (1 << LOAD_SHIFT)
+///The amount of seconds between load samples.
+#define LOAD_SAMPLE_SECONDS 5
+///The interrupt vector IRQ0 is remapped to by pic_init.
+#define TIMER_VECTOR 0x20
+///The master PIC's command port.
+#define PIC1_COMMAND 0x20
+///The master PIC's data port, which holds the interrupt mask.
+#define PIC1_DATA 0x21
+///The end of interrupt command.
+#define PIC_EOI 0x20
+
+extern void timer_isr(void *);
+
+///The rate the timer interrupts at, in hertz.
+static unsigned int timer_frequency = 0;
+///The PIT count between two periodic ticks.
+static unsigned int timer_divisor = 0;
+///The PIT count that passed while idle, but didn't add up to a whole tick.
+static unsigned int idle_remainder = 0;
+///The PIT count the one-shot timer was programmed with, 0 if the timer is periodic.
+static volatile unsigned int one_shot_count = 0;
+///The amount of ticks since the timer was initialized.
+static volatile unsigned long long timer_ticks = 0;
+///The amount of ticks a process may run before it's preempted, 0 to never preempt.
+static unsigned int time_quantum = 0;
+///The amount of ticks the running process has left.
+static unsigned int quantum_remaining = 0;
+
+/**
+ * @brief Orders sleeping PCBs by the tick they wake up at.
+ * @param node1 the first PCB's sleep node.
+ * @param node2 the second PCB's sleep node.
+ * @return negative if the first wakes first, positive if the second does, 0 if they wake together.
+ */
+static int sleep_cmp(pq_node *node1, pq_node *node2)
+{
+    unsigned long long wake1 = pq_entry(node1, struct pcb, sleep_node)->wake_tick;
+    unsigned long long wake2 = pq_entry(node2, struct pcb, sleep_node)->wake_tick;
+    return wake1 < wake2 ? -1 : wake1 > wake2;
+}
+
+///The sleeping PCBs, the one waking first at the front.
+static pqueue_t sleep_queue = {.cmp = &sleep_cmp};
+
+///How much of the 1, 5 and 15 minute load averages remains after a sample, e^(-5/60), e^(-5/300) and e^(-5/900).
+static const unsigned int load_decay[3] = {1884, 2014, 2037};
+///The 1, 5 and 15 minute load averages, with LOAD_SHIFT fractional bits.
+static unsigned int load_averages[3] = {0};
+///The tick the load is sampled at next.
+static unsigned long long next_load_tick = 0;
+
+/**
+ * @brief Samples the amount of runnable processes into the load averages, if a sample is due. Interrupts must be
+ * disabled.
+ */
+static void sample_load(void)
+{
+    if(timer_ticks < next_load_tick)
+        return;
+    next_load_tick = timer_ticks + LOAD_SAMPLE_SECONDS * timer_frequency;
+
+    unsigned int runnable = (unsigned int) runnable_pcb_count() << LOAD_SHIFT;
+    for (int i = 0; i < 3; ++i)
+        load_averages[i] = (load_averages[i] * load_decay[i] + runnable * (LOAD_ONE - load_decay[i])) >> LOAD_SHIFT;
+}
+
+/**
+ * @brief Programs channel 0 of the PIT.
+ * @param mode the command selecting the channel's mode.
+ * @param count the count to load, 0 meaning 65536.
+ */
+static void program_pit(int mode, unsigned int count)
+{
+    outb(PIT_COMMAND, mode);
+    outb(PIT_CHANNEL0, count & 0xFF);
+    outb(PIT_CHANNEL0, (count >> 8) & 0xFF);
+}
+
+/**
+ * @brief Wakes every sleeping PCB whose tick has come, moving it back to the ready queues. Interrupts must be
+ * disabled.
+ * @return true if any PCB woke up.
+ */
+static bool wake_sleepers(void)
+{
+    bool woke = false;
+    pq_node *node;
+    while ((node = pq_peek(&sleep_queue)) != NULL)
+    {
+        struct pcb *pcb_ptr = pq_entry(node, struct pcb, sleep_node);
+        if(pcb_ptr->wake_tick > timer_ticks)
+            break;
+
+        pq_pop(&sleep_queue);
+        pcb_remove(pcb_ptr);
+        pcb_ptr->exec_state = READY;
+        pcb_insert(pcb_ptr);
+        woke = true;
+    }
+    return woke;
+}
+
+/**
+ * @brief Ends the one-shot timer started by timer_idle, adding the time that passed to the tick count and
+ * going back to ticking periodically. Interrupts must be disabled.
+ * @param elapsed the PIT count that passed since the one-shot timer was programmed.
+ */
+static void end_one_shot(unsigned int elapsed)
+{
+    one_shot_count = 0;
+    idle_remainder += elapsed;
+    timer_ticks += idle_remainder / timer_divisor;
+    idle_remainder %= timer_divisor;
+    program_pit(PIT_RATE_GENERATOR, timer_divisor);
+    wake_sleepers();
+    sample_load();
+}
+
+void timer_init(unsigned int frequency, unsigned int quantum)
+{
+    if(frequency < PIT_BASE_FREQUENCY / 65536 + 1)
+        frequency = PIT_BASE_FREQUENCY / 65536 + 1;
+    if(frequency > PIT_BASE_FREQUENCY)
+        frequency = PIT_BASE_FREQUENCY;
+
+    timer_divisor = PIT_BASE_FREQUENCY / frequency;
+    timer_frequency = PIT_BASE_FREQUENCY / timer_divisor;
+    set_time_quantum(quantum);
+
+    cli();
+    idt_install(TIMER_VECTOR, timer_isr);
+    program_pit(PIT_RATE_GENERATOR, timer_divisor);
+
+    //Unmask IRQ0.
+    int mask = inb(PIC1_DATA);
+    mask &= ~1;
+    outb(PIC1_DATA, mask);
+    sti();
+}
+
+unsigned int get_timer_frequency(void)
+{
+    return timer_frequency;
+}
+
+unsigned long long get_timer_ticks(void)
+{
+    //The count is 64 bits, so read it with interrupts off to avoid a torn value.
+    unsigned int flags = irq_save();
+    unsigned long long ticks = timer_ticks;
+    irq_restore(flags);
+    return ticks;
+}
+
+void set_time_quantum(unsigned int quantum)
+{
+    time_quantum = quantum;
+    quantum_remaining = quantum;
+}
+
+unsigned int get_time_quantum(void)
+{
+    return time_quantum;
+}
+
+void reset_time_quantum(void)
+{
+    quantum_remaining = time_quantum;
+}
+
+void get_load_averages(unsigned int loads[3])
+{
+    for (int i = 0; i < 3; ++i)
+        loads[i] = (load_averages[i] * 100 + LOAD_ONE / 2) >> LOAD_SHIFT;
+}
+
+unsigned int ms_to_ticks(unsigned int ms)
+{
+    //Split into seconds, so the multiplication can't overflow. Partial ticks round up.
+    unsigned int ticks = ms / 1000 * timer_frequency;
+    return ticks + ((ms % 1000) * timer_frequency + 999) / 1000;
+}
+
+unsigned int ticks_to_ms(unsigned int ticks)
+{
+    if(timer_frequency == 0)
+        return 0;
+    return ticks / timer_frequency * 1000 + ticks % timer_frequency * 1000 / timer_frequency;
+}
+
+bool timer_sleep(struct pcb *pcb_ptr, unsigned long long wake_tick)
+{
+    unsigned int flags = irq_save();
+    pcb_ptr->wake_tick = wake_tick;
+    bool queued = pq_push(&sleep_queue, &pcb_ptr->sleep_node);
+    irq_restore(flags);
+    return queued;
+}
+
+void timer_cancel_sleep(struct pcb *pcb_ptr)
+{
+    unsigned int flags = irq_save();
+    if(pq_queued(&pcb_ptr->sleep_node))
+        pq_remove(&sleep_queue, &pcb_ptr->sleep_node);
+    irq_restore(flags);
+}
+
+unsigned long long next_wake_tick(void)
+{
+    unsigned int flags = irq_save();
+    pq_node *node = pq_peek(&sleep_queue);
+    unsigned long long wake_tick = node == NULL ? 0 : pq_entry(node, struct pcb, sleep_node)->wake_tick;
+    irq_restore(flags);
+    return wake_tick;
+}
+
+void timer_idle(unsigned long long wake_tick)
+{
+    //Without a timer, only other interrupts can wake the CPU.
+    if(timer_divisor == 0)
+    {
+        __asm__ volatile ("sti\n\thlt\n\tcli" ::: "memory");
+        return;
+    }
+
+    unsigned long long count = PIT_MAX_COUNT;
+    if(wake_tick != 0)
+    {
+        if(wake_tick <= timer_ticks)
+            return;
+
+        //Wake exactly on the tick, counting the part of the current tick that already passed while idle.
+        unsigned long long ticks_left = wake_tick - timer_ticks;
+        if(ticks_left <= PIT_MAX_COUNT / timer_divisor + 1)
+        {
+            count = ticks_left * timer_divisor - idle_remainder;
+            if(count > PIT_MAX_COUNT)
+                count = PIT_MAX_COUNT;
+        }
+    }
+
+    one_shot_count = (unsigned int) count;
+    program_pit(PIT_ONE_SHOT, one_shot_count);
+
+    //STI only takes effect after the following instruction, so no interrupt can slip in before the HLT.
+    __asm__ volatile ("sti\n\thlt\n\tcli" ::: "memory");
+
+    //Woken by another interrupt, so work out how much of the one-shot count passed.
+    if(one_shot_count != 0)
+    {
+        outb(PIT_COMMAND, PIT_LATCH);
+        unsigned int remaining = inb(PIT_CHANNEL0);
+        remaining |= inb(PIT_CHANNEL0) << 8;
+
+        //The count wraps around once it expires, its interrupt is still pending.
+        unsigned int elapsed = remaining > one_shot_count ? one_shot_count : one_shot_count - remaining;
+        end_one_shot(elapsed);
+    }
+}
+
+/**
+ * @brief The C half of the timer ISR. Counts the tick and preempts the running process once its quantum or
+ * real-time budget is used up.
+ * @param ctx the context of the interrupted process, saved by timer_isr.
+ * @return the context to switch to.
+ */
+struct context *timer_isr_intern(struct context *ctx)
+{
+    outb(PIC1_COMMAND, PIC_EOI);
+
+    //The CPU was idle, so there's no process to preempt.
+    if(one_shot_count != 0)
+    {
+        end_one_shot(one_shot_count);
+        return ctx;
+    }
+
+    timer_ticks++;
+    sample_load();
+    age_ready_pcbs();
+
+    //A process that just woke up may outrank the running one.
+    bool preempt = wake_sleepers();
+    struct pcb *active = get_active_pcb();
+    if(time_quantum != 0)
+    {
+        if(quantum_remaining > 1)
+        {
+            quantum_remaining--;
+        }
+        else
+        {
+            //Refill the quantum now, in case the scheduler decides to keep the process running.
+            quantum_remaining = time_quantum;
+            preempt = true;
+            if(active != NULL)
+                decay_pcb(active);
+        }
+    }
+
+    //A real-time process may only run for its budget each period.
+    if(active != NULL && charge_realtime(active))
+        return throttle_pcb(ctx);
+    return preempt ? preempt_pcb(ctx) : ctx;
+}
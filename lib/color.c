@@ -6,6 +6,7 @@
 #include "stddef.h"
 #include "string.h"
 #include "stdio.h"
+#include "intern.h"
 
 ///Information for the black ansii color.
 static const color_t BLACK = {.color_label = "black", .color_num = 30};
@@ -69,6 +70,11 @@ static const color_t *COLORS[] = {
         NULL
 };
 
+///The interned labels of the colors, in the same order as COLORS.
+static symbol_t COLOR_SYMBOLS[sizeof(COLORS) / sizeof(COLORS[0])];
+///If the color labels have been interned yet.
+static bool colors_interned = false;
+
 void set_output_color(const color_t *color)
 {
     if(color == NULL)
@@ -88,15 +94,22 @@ const color_t *get_output_color(void)
 
 const color_t *get_color(const char *label)
 {
-    //Iterate over all timezones.
-    int index = 0;
-    while(COLORS[index] != NULL)
+    if(!colors_interned)
+    {
+        for (int i = 0; COLORS[i] != NULL; ++i)
+            COLOR_SYMBOLS[i] = intern_static_ci(COLORS[i]->color_label);
+        colors_interned = true;
+    }
+
+    //A label that was never interned can't be a color.
+    symbol_t symbol = find_symbol_ci(label);
+    if(symbol == NULL)
+        return NULL;
+
+    for (int i = 0; COLORS[i] != NULL; ++i)
     {
-        //Get the color
-        const color_t *color = COLORS[index];
-        if(strcicmp(label, color->color_label) == 0)
-            return color;
-        index++;
+        if(COLOR_SYMBOLS[i] == symbol)
+            return COLORS[i];
     }
     return NULL;
 }
@@ -0,0 +1,86 @@
+#include "hash.h"
+#include "ctype.h"
+#include "string.h"
+
+///The FNV-1a 32-bit offset basis.
+#define FNV_OFFSET_BASIS 0x811C9DC5U
+///The FNV-1a 32-bit prime.
+#define FNV_PRIME 0x01000193U
+
+unsigned int hash_bytes(const void *data, size_t len)
+{
+    const unsigned char *bytes = data;
+    unsigned int hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+unsigned int hash_string(const char *str)
+{
+    unsigned int hash = FNV_OFFSET_BASIS;
+    for (const unsigned char *c = (const unsigned char *) str; *c != '\0'; ++c)
+    {
+        hash ^= *c;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+unsigned int hash_string_ci(const char *str)
+{
+    unsigned int hash = FNV_OFFSET_BASIS;
+    for (const unsigned char *c = (const unsigned char *) str; *c != '\0'; ++c)
+    {
+        hash ^= (unsigned int) tolower(*c);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+unsigned int hash_int(unsigned int x)
+{
+    //The murmur3 finalizer.
+    x ^= x >> 16;
+    x *= 0x85EBCA6BU;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35U;
+    x ^= x >> 16;
+    return x;
+}
+
+unsigned int hash_combine(unsigned int seed, unsigned int value)
+{
+    return hash_int(seed ^ (value + 0x9E3779B9U + (seed << 6) + (seed >> 2)));
+}
+
+unsigned int hash_coordinate(int x, int y)
+{
+    //Pack both halves into one word, then mix it. Rotating y keeps large components from cancelling.
+    unsigned int ux = (unsigned int) x;
+    unsigned int uy = (unsigned int) y;
+    return hash_int(ux ^ ((uy << 16) | (uy >> 16)) * 0x9E3779B1U);
+}
+
+int str_hash_func(void *str)
+{
+    return (int) hash_string(str);
+}
+
+int str_ci_hash_func(void *str)
+{
+    return (int) hash_string_ci(str);
+}
+
+bool str_equals(void *str1, void *str2)
+{
+    return strcmp(str1, str2) == 0;
+}
+
+bool str_ci_equals(void *str1, void *str2)
+{
+    return strcicmp(str1, str2) == 0;
+}
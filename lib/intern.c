@@ -0,0 +1,127 @@
+#include "intern.h"
+#include "hash.h"
+#include "string.h"
+#include "stddef.h"
+#include "mpx/interrupts.h"
+
+///The amount of slots in the table, a power of two. INTERN_MAX_SYMBOLS keeps the load factor at 3/4.
+#define INTERN_CAPACITY 512
+
+///A slot in the symbol table.
+struct symbol_slot
+{
+    ///The canonical string, NULL if the slot is empty.
+    const char *str;
+    ///The hash of the string, from hash_string_ci if folded and hash_string if not.
+    unsigned int hash;
+    ///If the symbol belongs to the case insensitive namespace.
+    bool folded;
+};
+
+///The symbol table. It's static so strings can be interned before the heap exists.
+static struct symbol_slot symbols[INTERN_CAPACITY];
+///The amount of symbols in the table.
+static int symbols_size;
+
+/**
+ * @brief Hashes the string for the given namespace.
+ * @param str the string.
+ * @param folded if the case insensitive namespace is being searched.
+ * @return the hash.
+ */
+static inline unsigned int symbol_hash(const char *str, bool folded)
+{
+    return folded ? hash_string_ci(str) : hash_string(str);
+}
+
+/**
+ * @brief Finds the slot holding the string, or the empty slot ending its probe sequence.
+ * @param str the string.
+ * @param hash the hash of the string.
+ * @param folded if the case insensitive namespace is being searched.
+ * @return the slot index.
+ */
+static int find_slot(const char *str, unsigned int hash, bool folded)
+{
+    int index = (int) (hash & (INTERN_CAPACITY - 1));
+    while (symbols[index].str != NULL)
+    {
+        struct symbol_slot *slot = &symbols[index];
+        if(slot->hash == hash && slot->folded == folded &&
+                (folded ? strcicmp(slot->str, str) : strcmp(slot->str, str)) == 0)
+            return index;
+
+        index = (index + 1) & (INTERN_CAPACITY - 1);
+    }
+    return index;
+}
+
+/**
+ * @brief Interns the string, adding it to the table if necessary.
+ * @param str the string, which must live forever.
+ * @param folded if the case insensitive namespace should be used.
+ * @return the symbol, or NULL if the table is full.
+ */
+static symbol_t intern_in(const char *str, bool folded)
+{
+    if(str == NULL)
+        return NULL;
+
+    //Processes can be preempted mid insert, which would leave a half written probe sequence for the next one.
+    unsigned int hash = symbol_hash(str, folded);
+    unsigned int flags = irq_save();
+    struct symbol_slot *slot = &symbols[find_slot(str, hash, folded)];
+    if(slot->str == NULL && symbols_size < INTERN_MAX_SYMBOLS)
+    {
+        slot->str = str;
+        slot->hash = hash;
+        slot->folded = folded;
+        symbols_size++;
+    }
+    symbol_t symbol = slot->str;
+    irq_restore(flags);
+    return symbol;
+}
+
+/**
+ * @brief Finds the symbol for the string without interning it.
+ * @param str the string.
+ * @param folded the namespace to search.
+ * @return the symbol, or NULL if it isn't interned.
+ */
+static symbol_t find_in(const char *str, bool folded)
+{
+    if(str == NULL)
+        return NULL;
+
+    unsigned int hash = symbol_hash(str, folded);
+    unsigned int flags = irq_save();
+    symbol_t symbol = symbols[find_slot(str, hash, folded)].str;
+    irq_restore(flags);
+    return symbol;
+}
+
+symbol_t intern_static(const char *str)
+{
+    return intern_in(str, false);
+}
+
+symbol_t intern_static_ci(const char *str)
+{
+    return intern_in(str, true);
+}
+
+symbol_t find_symbol(const char *str)
+{
+    return find_in(str, false);
+}
+
+symbol_t find_symbol_ci(const char *str)
+{
+    return find_in(str, true);
+}
+
+int symbol_count(void)
+{
+    return symbols_size;
+}
@@ -3,6 +3,7 @@
 //
 
 #include "math.h"
+#include "hash.h"
 
 int abs(int x)
 {
@@ -46,44 +47,131 @@ double pow(double a, double b)
     return 1;
 }
 
-///The LCRNG multiplier from C++.
-#define SEED_MULTI 25214903917L
-///The LCRNG addend from C++.
-#define SEED_ADDEND 11L
-///The bit mask to apply to the seed
-#define SEED_MASK (0xFFFFFFFFFFFFL - 1L)
+///The golden ratio constant, used to spread seeds and stream ids apart.
+#define GOLDEN_GAMMA 0x9E3779B9U
 
-///The seed for random number generation.
-static unsigned long long rand_seed = 0L;
+///The stream used when no process has installed its own, i.e. during boot.
+static rand_state_t kernel_rand_state = {.s = {0x243F6A88U, 0x85A308D3U, 0x13198A2EU, 0x03707344U}};
+///The stream used by the next_random family.
+static rand_state_t *active_rand_state = &kernel_rand_state;
 
-unsigned long long get_seed(void)
+/**
+ * @brief Rotates the value left.
+ * @param x the value.
+ * @param k the amount of bits to rotate by.
+ * @return the rotated value.
+ */
+static inline unsigned int rotl(unsigned int x, int k)
 {
-    return rand_seed;
+    return (x << k) | (x >> (32 - k));
+}
+
+void rand_seed(rand_state_t *state, unsigned long long seed)
+{
+    rand_stream(state, seed, 0);
+}
+
+void rand_stream(rand_state_t *state, unsigned long long seed, unsigned int stream)
+{
+    //Expand the seed into the full state, the same way splitmix does.
+    unsigned int lo = (unsigned int) seed;
+    unsigned int hi = (unsigned int) (seed >> 32);
+    unsigned int x = lo ^ hash_int(hi + stream * GOLDEN_GAMMA);
+    for (int i = 0; i < 4; ++i)
+    {
+        x += GOLDEN_GAMMA;
+        state->s[i] = hash_int(x ^ (stream << (i * 8)));
+    }
+
+    //The all zero state is the one state xoshiro can't leave.
+    if ((state->s[0] | state->s[1] | state->s[2] | state->s[3]) == 0)
+        state->s[0] = GOLDEN_GAMMA;
+}
+
+unsigned int rand_next(rand_state_t *state)
+{
+    //xoshiro128**, only 32-bit shifts, xors and multiplies.
+    unsigned int *s = state->s;
+    unsigned int result = rotl(s[1] * 5, 7) * 9;
+    unsigned int t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 11);
+    return result;
+}
+
+unsigned int rand_next_lim(rand_state_t *state, unsigned int limit)
+{
+    //Scale into the range with a multiply instead of a division.
+    return (unsigned int) (((unsigned long long) rand_next(state) * limit) >> 32);
+}
+
+void rand_jump(rand_state_t *state)
+{
+    static const unsigned int JUMP[4] = {0x8764000BU, 0xF542D2D3U, 0x6FA035C3U, 0x77F2DB5BU};
+
+    unsigned int jumped[4] = {0};
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int bit = 0; bit < 32; ++bit)
+        {
+            if (JUMP[i] & (1U << bit))
+            {
+                for (int j = 0; j < 4; ++j)
+                    jumped[j] ^= state->s[j];
+            }
+            rand_next(state);
+        }
+    }
+
+    for (int j = 0; j < 4; ++j)
+        state->s[j] = jumped[j];
+}
+
+void rand_fill(rand_state_t *state, unsigned int *buffer, size_t count)
+{
+    //Work on a local copy so the state can live in registers.
+    rand_state_t local = *state;
+    for (size_t i = 0; i < count; ++i)
+    {
+        buffer[i] = rand_next(&local);
+    }
+    *state = local;
+}
+
+void set_rand_state(rand_state_t *state)
+{
+    active_rand_state = state != NULL ? state : &kernel_rand_state;
+}
+
+rand_state_t *get_rand_state(void)
+{
+    return active_rand_state;
 }
 
 void s_rand(unsigned long long seed)
 {
-    //Apply the initial scramble of the seed.
-    rand_seed = (seed ^ SEED_MULTI) & SEED_MASK;
+    rand_seed(active_rand_state, seed);
 }
 
 unsigned int next_random(void)
 {
-    //Find the next seed.
-    unsigned long long next_seed = (rand_seed * SEED_MULTI + SEED_ADDEND) & SEED_MASK;
-
-    //Read 32 bits from the seed.
-    unsigned int thing = (int) (next_seed >> 16L);
-    rand_seed = next_seed;
-    return thing;
+    return rand_next(active_rand_state);
 }
 
 unsigned int next_random_lim(int limit)
 {
-    return ui_realmod((int) next_random(), limit);
+    if (limit <= 0)
+        return 0;
+
+    return rand_next_lim(active_rand_state, (unsigned int) limit);
 }
 
 bool next_rand_bool(void)
 {
-    return next_random_lim(2) == 0;
-}
\ No newline at end of file
+    return (next_random() >> 31) == 0;
+}
@@ -13,7 +13,8 @@
 #include "print_format.h"
 #include "math.h"
 
-#define PRINTF_BUF_LEN 500
+///The size of the chunk printf gathers small pieces of output into before writing.
+#define PRINTF_CHUNK_LEN 64
 
 char *gets(char *str_buf, size_t buf_len)
 {
@@ -38,12 +39,12 @@ char pollc(void)
  * An internal method to mess with the user. It will randomly inject formatting codes to change things like bolding or blinking.
  *
  * @param s the text to print.
+ * @param str_len the amount of characters to print.
  */
-void print_funny(const char *s)
+void print_funny_len(const char *s, size_t str_len)
 {
-    int str_len = (int) strlen(s);
     const color_t *color = get_output_color();
-    for (int i = 0; i < str_len; ++i)
+    for (size_t i = 0; i < str_len; ++i)
     {
         char c = s[i];
         unsigned int next_rand = next_random();
@@ -67,6 +68,16 @@ void print_funny(const char *s)
     clear_formats();
 }
 
+/**
+ * An internal method to mess with the user. It will randomly inject formatting codes to change things like bolding or blinking.
+ *
+ * @param s the text to print.
+ */
+void print_funny(const char *s)
+{
+    print_funny_len(s, strlen(s));
+}
+
 void print(const char *s)
 {
     int str_len = (int) strlen(s);
@@ -74,38 +85,93 @@ void print(const char *s)
     sys_req(WRITE, COM1, s, str_len);
 }
 
+///The state used while streaming printf output.
+typedef struct {
+    ///Small pieces of output are gathered here to save on write requests.
+    char chunk[PRINTF_CHUNK_LEN];
+    ///The amount of bytes waiting in the chunk.
+    size_t len;
+} printf_state_t;
+
+/**
+ * @brief Checks if the text contains an ANSI escape character.
+ * @param s the text.
+ * @param len the length of the text.
+ * @return true if an escape character was found.
+ */
+static bool has_escape(const char *s, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        if(s[i] == 27)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Writes the given text to standard output.
+ * @param s the text.
+ * @param len the amount of characters to write.
+ */
+static void printf_write(const char *s, size_t len)
+{
+    if(len == 0)
+        return;
+
+    //Don't mess with text carrying its own escape codes.
+    if(FUNNY_MODE && !has_escape(s, len))
+        print_funny_len(s, len);
+    else
+        sys_req(WRITE, COM1, s, len);
+}
+
+/**
+ * @brief Writes out anything gathered in the chunk.
+ * @param state the printf state.
+ */
+static void printf_flush(printf_state_t *state)
+{
+    printf_write(state->chunk, state->len);
+    state->len = 0;
+}
+
+/**
+ * @brief The sink used by printf. Small pieces are gathered into the chunk, large
+ *        pieces are written straight from where they already live.
+ * @param ctx the printf state.
+ * @param s the text.
+ * @param len the length of the text.
+ */
+static void printf_sink(void *ctx, const char *s, size_t len)
+{
+    printf_state_t *state = ctx;
+    if(state->len + len > PRINTF_CHUNK_LEN)
+        printf_flush(state);
+
+    if(len >= PRINTF_CHUNK_LEN)
+    {
+        printf_write(s, len);
+        return;
+    }
+
+    memcpy(state->chunk + state->len, s, len);
+    state->len += len;
+}
+
 int printf(const char *s, ...)
 {
-    char buffer[PRINTF_BUF_LEN] = {0};
+    printf_state_t state;
+    state.len = 0;
 
-    //Format the string.
+    //Format the string, streaming it to the output.
     va_list va;
     va_start(va, s);
-    char *result = vsprintf(s, buffer, PRINTF_BUF_LEN, va);
+    int result = vformat(&printf_sink, &state, s, va);
     va_end(va);
-    if (result == NULL)
-        return -1;
-
-    if(FUNNY_MODE)
-    {
-        bool should_print = true;
-        size_t len = sizeof (result);
-        for (size_t i = 0; i < len; ++i)
-        {
-            if(result[i] == 27)
-                should_print = false;
-        }
 
-        if(should_print)
-            print_funny(result);
-        else
-            print(result);
-    }
-    else
-    {
-        print(result);
-    }
-    return 0;
+    printf_flush(&state);
+    return result < 0 ? -1 : 0;
 }
 
 void clearscr(void)
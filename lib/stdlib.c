@@ -3,9 +3,30 @@
 #include <stddef.h>
 #include <string.h>
 #include "stdio.h"
+#include "memory.h"
+
+///Ranges this size or smaller are finished with insertion sort.
+#define INSERTION_SORT_THRESHOLD 16
+///The number of bits sorted per radix sort pass.
+#define RADIX_BITS 8
+///The number of buckets per radix sort pass.
+#define RADIX_BUCKETS (1 << RADIX_BITS)
 
 static const char *num_encoding = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
 
+///Every two digit decimal number, back to back. Lets decimal conversion emit two digits per division.
+static const char digit_pairs[201] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
 int atoi(const char *s)
 {
     int res = 0;
@@ -91,56 +112,80 @@ char *itoa(int i, char *str_buf, int buf_len)
 {
     return itoa_base(i, 10, str_buf, buf_len);
 }
-//Converts a number to a string
-char *itoa_base(int i, int base, char *str_buf, int buf_len)
+
+char *utoa_digits(unsigned int value, int base, char *end)
 {
-    if (buf_len == 0) {
-        return NULL;
+    //Base 10 is by far the most common, so emit two digits per division.
+    if (base == 10)
+    {
+        while (value >= 100)
+        {
+            unsigned int pair = (value % 100) * 2;
+            value /= 100;
+            *--end = digit_pairs[pair + 1];
+            *--end = digit_pairs[pair];
+        }
+
+        if (value >= 10)
+        {
+            *--end = digit_pairs[value * 2 + 1];
+            *--end = digit_pairs[value * 2];
+        }
+        else
+        {
+            *--end = (char) ('0' + value);
+        }
+        return end;
     }
 
-    if (i == 0)
+    //Powers of two can be handled with shifts instead of divisions.
+    if (base == 16)
     {
+        do {
+            *--end = num_encoding[value & 0xF];
+            value >>= 4;
+        } while (value > 0);
+        return end;
+    }
+
+    do {
+        *--end = num_encoding[value % (unsigned int) base];
+        value /= (unsigned int) base;
+    } while (value > 0);
+    return end;
+}
 
-        str_buf[0] = '0';
-        return str_buf;
+//Converts a number to a string
+char *itoa_base(int i, int base, char *str_buf, int buf_len)
+{
+    if (buf_len <= 0 || base < 2 || base > 36)
+    {
+        return NULL;
     }
 
     int num_pos = 0;
 
-    //Check for a sign.
+    //Check for a sign. The magnitude is taken as unsigned so INT_MIN survives.
+    unsigned int magnitude = (unsigned int) i;
     if (i < 0)
     {
         str_buf[0] = '-';
-        i *= -1;
+        magnitude = 0U - magnitude;
         num_pos = 1;
     }
 
-    if (buf_len <= num_pos)
-    {
-        return NULL;
-    }
-
-    //Loop through the number, removing a single digit at a time.
-    char swap[10] = {0};
-    int num_index = 0;
-    while (i > 0)
-    {
-        int digit = i % base;
-
-        swap[num_index++] = num_encoding[digit];
-
-        i /= base;
-    }
+    //Convert into the end of a scratch area large enough for any base.
+    char digits[UTOA_MAX_DIGITS];
+    char *end = digits + UTOA_MAX_DIGITS;
+    char *start = utoa_digits(magnitude, base, end);
+    int num_len = (int) (end - start);
 
     //If this is the case, we can't store the string.
-    if (num_index + num_pos >= buf_len)
+    if (num_len + num_pos >= buf_len)
         return NULL;
 
-    //Put all chars from swap into the buffer.
-    for (int index = num_index - 1; index >= 0; --index)
-    {
-        str_buf[num_pos++] = swap[index];
-    }
+    memcpy(str_buf + num_pos, start, num_len);
+    str_buf[num_pos + num_len] = '\0';
     return str_buf;
 }
 
@@ -167,3 +212,260 @@ int atox(const char *s)
 
     return value;
 }
+
+
+/**
+ * @brief Swaps two elements of the given size.
+ * @param a the first element.
+ * @param b the second element.
+ * @param size the size of the elements.
+ */
+static void sort_swap(unsigned char *a, unsigned char *b, size_t size)
+{
+    //Word sized elements (pointers, ints) are by far the most common.
+    if (size == sizeof(int))
+    {
+        int tmp = *(int *) a;
+        *(int *) a = *(int *) b;
+        *(int *) b = tmp;
+        return;
+    }
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        unsigned char tmp = a[i];
+        a[i] = b[i];
+        b[i] = tmp;
+    }
+}
+
+/**
+ * @brief Sorts a small range with insertion sort.
+ * @param base the first element.
+ * @param count the amount of elements.
+ * @param size the size of each element.
+ * @param cmp the comparison function.
+ */
+static void insertion_sort(unsigned char *base, size_t count, size_t size,
+                           int (*cmp)(const void *, const void *))
+{
+    for (size_t i = 1; i < count; ++i)
+    {
+        for (size_t j = i; j > 0 && cmp(base + (j - 1) * size, base + j * size) > 0; --j)
+        {
+            sort_swap(base + (j - 1) * size, base + j * size, size);
+        }
+    }
+}
+
+/**
+ * @brief Moves the element at the given index down the max heap until the heap property holds.
+ * @param base the first element.
+ * @param root the index to sift down.
+ * @param count the amount of elements in the heap.
+ * @param size the size of each element.
+ * @param cmp the comparison function.
+ */
+static void sift_down(unsigned char *base, size_t root, size_t count, size_t size,
+                      int (*cmp)(const void *, const void *))
+{
+    size_t child;
+    while ((child = root * 2 + 1) < count)
+    {
+        if (child + 1 < count && cmp(base + child * size, base + (child + 1) * size) < 0)
+            child++;
+
+        if (cmp(base + root * size, base + child * size) >= 0)
+            return;
+
+        sort_swap(base + root * size, base + child * size, size);
+        root = child;
+    }
+}
+
+/**
+ * @brief Sorts the range with heap sort. Used when quick sort recurses too deeply.
+ * @param base the first element.
+ * @param count the amount of elements.
+ * @param size the size of each element.
+ * @param cmp the comparison function.
+ */
+static void heap_sort(unsigned char *base, size_t count, size_t size,
+                      int (*cmp)(const void *, const void *))
+{
+    for (size_t i = count / 2; i > 0; --i)
+    {
+        sift_down(base, i - 1, count, size, cmp);
+    }
+
+    for (size_t end = count - 1; end > 0; --end)
+    {
+        sort_swap(base, base + end * size, size);
+        sift_down(base, 0, end, size, cmp);
+    }
+}
+
+/**
+ * @brief The introsort loop. Quick sorts until ranges are small, falling back to heap sort
+ *        if the depth limit is exhausted. Small ranges are left for the final insertion sort.
+ * @param base the first element.
+ * @param count the amount of elements.
+ * @param size the size of each element.
+ * @param cmp the comparison function.
+ * @param depth the remaining recursion depth.
+ */
+static void intro_sort(unsigned char *base, size_t count, size_t size,
+                       int (*cmp)(const void *, const void *), int depth)
+{
+    while (count > INSERTION_SORT_THRESHOLD)
+    {
+        if (depth-- == 0)
+        {
+            heap_sort(base, count, size, cmp);
+            return;
+        }
+
+        //Median of three, leaving the pivot at the front.
+        unsigned char *first = base;
+        unsigned char *mid = base + (count / 2) * size;
+        unsigned char *last = base + (count - 1) * size;
+        if (cmp(mid, first) < 0)
+            sort_swap(mid, first, size);
+        if (cmp(last, mid) < 0)
+        {
+            sort_swap(last, mid, size);
+            if (cmp(mid, first) < 0)
+                sort_swap(mid, first, size);
+        }
+        sort_swap(first, mid, size);
+
+        //Hoare partition around the pivot.
+        size_t lo = 1;
+        size_t hi = count - 1;
+        while (true)
+        {
+            while (lo <= hi && cmp(base + lo * size, first) < 0)
+                lo++;
+            while (cmp(base + hi * size, first) > 0)
+                hi--;
+            if (lo >= hi)
+                break;
+
+            sort_swap(base + lo * size, base + hi * size, size);
+            lo++;
+            hi--;
+        }
+        sort_swap(first, base + hi * size, size);
+
+        //Recurse into the smaller half, loop on the larger to bound stack use.
+        size_t left = hi;
+        size_t right = count - hi - 1;
+        if (left < right)
+        {
+            intro_sort(base, left, size, cmp, depth);
+            base += (hi + 1) * size;
+            count = right;
+        }
+        else
+        {
+            intro_sort(base + (hi + 1) * size, right, size, cmp, depth);
+            count = left;
+        }
+    }
+}
+
+void qsort(void *base, size_t count, size_t size, int (*cmp)(const void *, const void *))
+{
+    if (base == NULL || count < 2 || size == 0)
+        return;
+
+    //Allow twice the ideal depth before giving up on quick sort.
+    int depth = 0;
+    for (size_t n = count; n > 1; n >>= 1)
+    {
+        depth += 2;
+    }
+
+    intro_sort(base, count, size, cmp, depth);
+    insertion_sort(base, count, size, cmp);
+}
+
+int radix_sort(unsigned int *keys, void **values, size_t count)
+{
+    if (keys == NULL || count < 2)
+        return 0;
+
+    //Scratch space for a single pass, the passes ping-pong between the two.
+    //The bucket offsets live on the heap too, as they would take up a good part of a process stack.
+    unsigned int *key_tmp = sys_alloc_mem(sizeof(unsigned int) * count);
+    void **value_tmp = values != NULL ? sys_alloc_mem(sizeof(void *) * count) : NULL;
+    size_t *offsets = sys_alloc_mem(sizeof(size_t) * RADIX_BUCKETS);
+    if (key_tmp == NULL || (values != NULL && value_tmp == NULL) || offsets == NULL)
+    {
+        if (key_tmp != NULL)
+            sys_free_mem(key_tmp);
+        if (value_tmp != NULL)
+            sys_free_mem(value_tmp);
+        if (offsets != NULL)
+            sys_free_mem(offsets);
+        return -1;
+    }
+
+    unsigned int *key_src = keys, *key_dst = key_tmp;
+    void **value_src = values, **value_dst = value_tmp;
+    for (int shift = 0; shift < (int) (sizeof(unsigned int) * 8); shift += RADIX_BITS)
+    {
+        for (int bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+            offsets[bucket] = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            offsets[(key_src[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+        }
+
+        //A pass where every key lands in the same bucket changes nothing.
+        if (offsets[(key_src[0] >> shift) & (RADIX_BUCKETS - 1)] == count)
+            continue;
+
+        //Turn the counts into starting offsets.
+        size_t total = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+        {
+            size_t bucket_count = offsets[bucket];
+            offsets[bucket] = total;
+            total += bucket_count;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t dst = offsets[(key_src[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+            key_dst[dst] = key_src[i];
+            if (values != NULL)
+                value_dst[dst] = value_src[i];
+        }
+
+        unsigned int *key_swap = key_src;
+        key_src = key_dst;
+        key_dst = key_swap;
+        void **value_swap = value_src;
+        value_src = value_dst;
+        value_dst = value_swap;
+    }
+
+    //Make sure the result ends up in the caller's arrays.
+    //This is copied by hand since memcpy bounces through a stack buffer.
+    if (key_src != keys)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            keys[i] = key_src[i];
+            if (values != NULL)
+                values[i] = value_src[i];
+        }
+    }
+
+    sys_free_mem(key_tmp);
+    if (value_tmp != NULL)
+        sys_free_mem(value_tmp);
+    sys_free_mem(offsets);
+    return 0;
+}
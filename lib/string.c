@@ -7,6 +7,16 @@
 #define UPPER_CASE 1
 #define LOWER_CASE 0
 
+/**
+ * @brief Checks if the given character ends a formatting specifier.
+ * @param c the character.
+ * @return non-zero if the character is a conversion character.
+ */
+static int is_conversion_char(char c)
+{
+    return c == 's' || c == 'c' || c == 'd' || c == 'u' || c == 'x' || c == '%';
+}
+
 /**
  * @brief An internal method used to change the case of a string.
  * @param str the original string.
@@ -262,191 +272,197 @@ char *strtok(char *restrict s1, const char *restrict s2)
     return s1;
 }
 
+///A run of zeros used to emit zero padding without a scratch buffer.
+static const char ZERO_FILL[16] = "0000000000000000";
+///The maximum amount of characters allowed between a '%' and its conversion character.
+#define FORMAT_MAX_ARGS 5
+
 /**
- * @brief Formats a decimal for a string. Returns a pointer to the formatted number,
- *        or NULL if the formatting was invalid.
- *        TODO When dynamically freeing RAM works, use that instead of passed buffers.
- * @param num the number to format.
- * @param args the arguments of formatting.
+ * @brief Emits a number through the sink, applying zero fill if requested.
+ *        Digits are produced into a small local array and sent in one piece.
+ * @param sink the sink to emit to.
+ * @param ctx the sink's context.
+ * @param num the number to emit.
+ * @param is_signed if the number should be treated as signed.
+ * @param args the arguments between the '%' and the conversion character.
  * @param arg_len the length of the arguments.
- * @param buf the buffer to store the resulting string.
- * @param buf_len the length of this buffer.
- * @param base the base of the number
- * @return a pointer to the resulting string, or NULL.
+ * @param base the base of the number.
+ * @return the amount of characters emitted.
  */
-char *f_decimal(int num, const char *args, size_t arg_len, char *buf, size_t buf_len, int base)
+static int f_number(format_sink_t sink, void *ctx, unsigned int num, bool is_signed,
+                    const char *args, int arg_len, int base)
 {
-    //Check the extra data.
-    bool fill_zeros = arg_len > 1 ? args[0] == '0' : false;
-    int arg_start_pos = fill_zeros ? 1 : 0;
-    int fill_count = fill_zeros && arg_len > 1 ? atoi(args + arg_start_pos) : 0;
-    if (fill_count < 0)
-        return NULL;
-
-    //Convert the argument.
-    size_t total_possible_count = fill_count >= 34 ? fill_count : 34;
+    //Only '0' prefixed widths are supported, i.e. '%02d'.
+    bool fill_zeros = arg_len > 1 && args[0] == '0';
+    int fill_count = 0;
+    for (int i = 1; fill_zeros && i < arg_len && isdigit(args[i]); ++i)
+    {
+        fill_count = fill_count * 10 + (args[i] - '0');
+    }
 
-    //Check bounds.
-    if (total_possible_count + 1 > buf_len)
-        return NULL;
+    bool negative = is_signed && (int) num < 0;
+    if (negative)
+        num = 0U - num;
 
-    //Convert the number.
-    memset(buf, 0, total_possible_count + 1);
-    itoa_base(num, base, buf, 34);
-    int len = (int) strlen(buf);
-    int total_fill_amount = fill_count - len;
+    char digits[UTOA_MAX_DIGITS];
+    char *end = digits + UTOA_MAX_DIGITS;
+    char *start = utoa_digits(num, base, end);
+    int len = (int) (end - start);
 
-    //Check if we need to fill zeros.
-    if (fill_zeros && total_fill_amount > 0)
+    int written = 0;
+    if (negative)
     {
-        bool negative = buf[0] == '-';
-
-        int start_pos = negative ? 1 : 0;
-        memcpy(buf + start_pos + total_fill_amount, buf, 34);
-
-        for (int k = 0; k < total_fill_amount; ++k)
-        {
-            buf[k + start_pos] = '0';
-        }
+        sink(ctx, "-", 1);
+        written++;
     }
-    return buf;
-}
 
-char *sprintf(const char *s, char *str, size_t buf_len, ...)
-{
-    va_list va;
-    va_start(va, buf_len);
-    char *result = vsprintf(s, str, buf_len, va);
-    va_end(va);
+    //The sign counts toward the fill width.
+    int fill = fill_count - len - (negative ? 1 : 0);
+    while (fill > 0)
+    {
+        int chunk = fill > (int) sizeof(ZERO_FILL) ? (int) sizeof(ZERO_FILL) : fill;
+        sink(ctx, ZERO_FILL, chunk);
+        fill -= chunk;
+        written += chunk;
+    }
 
-    return result;
+    sink(ctx, start, len);
+    return written + len;
 }
 
-char *vsprintf(const char *s, char *str, size_t buf_len, va_list va)
+int vformat(format_sink_t sink, void *ctx, const char *s, va_list va)
 {
-    //Get the string length and try to format it.
-    int str_len = (int) strlen(s);
-
-    int str_ind = 0;
-    for (int i = 0; i < str_len; ++i)
+    int written = 0;
+    while (*s)
     {
-        char at = s[i];
-
-        //If we've found the formatting symbol, try to format.
-        if (at != '%')
+        //Emit the literal run up to the next formatting symbol in one piece.
+        const char *run = s;
+        while (*s && *s != '%')
+            s++;
+        if (s != run)
         {
-            str[str_ind++] = at;
-            continue;
+            sink(ctx, run, s - run);
+            written += (int) (s - run);
         }
 
+        if (*s == '\0')
+            break;
+
         //Find the appropriate formatting
-        char arguments[5] = {0};
-        int arg_count = 0;
-        for (int j = i + 1; j < str_len; ++j)
+        const char *args = ++s;
+        while (*s && is_conversion_char(*s) == 0)
+        {
+            //If the argument was improperly defined, return.
+            if (s - args >= FORMAT_MAX_ARGS)
+                return -1;
+            s++;
+        }
+
+        //An unterminated specifier emits the rest of the string as-is.
+        if (*s == '\0')
         {
-            char f_code = s[j];
-            if (f_code == 's')
+            sink(ctx, args, s - args);
+            written += (int) (s - args);
+            break;
+        }
+
+        int arg_count = (int) (s - args);
+        char f_code = *s++;
+        switch (f_code)
+        {
+            case 's':
             {
                 //Arguments not supported for strings.
                 if (arg_count > 0)
-                    return NULL;
-
-                i = j;
-
-                char *arg = va_arg(va, char *);
+                    return -1;
 
+                const char *arg = va_arg(va, const char *);
                 size_t len = strlen(arg);
-                if(len + str_ind >= buf_len)
-                {
-                    break;
-                }
-                for (size_t k = 0; k < len; ++k)
-                {
-                    str[str_ind++] = arg[k];
-                }
-                break;
-            }
-            else if (f_code == 'x')
-            {
-                i = j;
-
-                //Check the extra data.
-                char fbuffer[50] = {0};
-                char *result = f_decimal(va_arg(va, int),
-                                         arguments,
-                                         arg_count,
-                                         fbuffer,
-                                         50,
-                                         16);
-                size_t len = strlen(fbuffer);
-                if (result == NULL)
-                {
-                    return NULL;
-                }
-
-                //Insert string.
-                for (size_t k = 0; k < len; ++k)
-                {
-                    str[str_ind++] = fbuffer[k];
-                }
-                break;
-            }
-            else if (f_code == 'd')
-            {
-                i = j;
-
-                //Check the extra data.
-                char fbuffer[50] = {0};
-                char *result = f_decimal(va_arg(va, int),
-                                         arguments,
-                                         arg_count,
-                                         fbuffer,
-                                         50,
-                                         10);
-                size_t len = strlen(fbuffer);
-                if (result == NULL)
-                {
-                    return NULL;
-                }
-
-                //Insert string.
-                for (size_t k = 0; k < len; ++k)
-                {
-                    str[str_ind++] = fbuffer[k];
-                }
+                sink(ctx, arg, len);
+                written += (int) len;
                 break;
             }
-            else if (f_code == 'c')
+            case 'c':
             {
                 //Multi args not supported.
                 if (arg_count > 0)
-                    return NULL;
-
-                i = j;
-                char val = va_arg(va, int);
+                    return -1;
 
-                str[str_ind++] = val;
+                char val = (char) va_arg(va, int);
+                sink(ctx, &val, 1);
+                written++;
                 break;
-            } else if (f_code == '%')
+            }
+            case '%':
             {
                 //Multiple arguments not supported.
                 if (arg_count > 0)
-                    return NULL;
+                    return -1;
 
-                i = j;
-                str[str_ind++] = '%';
+                sink(ctx, "%", 1);
+                written++;
                 break;
             }
-
-            //If the argument was improperly defined, return.
-            if (arg_count >= 5)
-                return NULL;
-
-            arguments[arg_count++] = f_code;
+            case 'd':
+                written += f_number(sink, ctx, (unsigned int) va_arg(va, int), true, args, arg_count, 10);
+                break;
+            case 'u':
+                written += f_number(sink, ctx, va_arg(va, unsigned int), false, args, arg_count, 10);
+                break;
+            case 'x':
+                written += f_number(sink, ctx, (unsigned int) va_arg(va, int), true, args, arg_count, 16);
+                break;
         }
     }
-    str[str_ind] = '\0';
-    return str;
+    return written;
+}
+
+///The state used by the buffer sink for the sprintf family.
+typedef struct {
+    ///The buffer being written to.
+    char *buffer;
+    ///The length of the buffer, including space for the null terminator.
+    size_t buf_len;
+    ///The amount of characters stored so far.
+    size_t pos;
+} buffer_sink_t;
+
+/**
+ * @brief A sink that copies into a fixed size buffer, silently truncating.
+ * @param ctx the buffer sink state.
+ * @param chunk the chunk of text.
+ * @param len the length of the chunk.
+ */
+static void buffer_sink(void *ctx, const char *chunk, size_t len)
+{
+    buffer_sink_t *state = ctx;
+    size_t room = state->buf_len - 1 - state->pos;
+    if (len > room)
+        len = room;
+
+    memcpy(state->buffer + state->pos, chunk, len);
+    state->pos += len;
+}
+
+char *sprintf(const char *s, char *str, size_t buf_len, ...)
+{
+    va_list va;
+    va_start(va, buf_len);
+    char *result = vsprintf(s, str, buf_len, va);
+    va_end(va);
+
+    return result;
+}
+
+char *vsprintf(const char *s, char *str, size_t buf_len, va_list va)
+{
+    if (str == NULL || buf_len == 0)
+        return NULL;
+
+    buffer_sink_t state = {.buffer = str, .buf_len = buf_len, .pos = 0};
+    int result = vformat(&buffer_sink, &state, s, va);
+    str[state.pos] = '\0';
+    return result < 0 ? NULL : str;
 }
 
 bool startsWith(const char *string, const char *startingString)
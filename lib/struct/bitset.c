@@ -0,0 +1,199 @@
+#include "bitset.h"
+
+/**
+ * @brief Gets the mask of the bits in the last word that belong to the set.
+ * @param set the bitset.
+ * @return the mask.
+ */
+static inline unsigned int last_word_mask(const bitset_t *set)
+{
+    int used = set->bits % BITSET_WORD_BITS;
+    return used == 0 ? 0xFFFFFFFFU : (1U << used) - 1;
+}
+
+/**
+ * @brief Sets or clears a range of bits a word at a time.
+ * @param set the bitset.
+ * @param start the first bit.
+ * @param count the amount of bits.
+ * @param value true to set them, false to clear them.
+ */
+static void assign_range(bitset_t *set, int start, int count, bool value)
+{
+    if(start < 0)
+    {
+        count += start;
+        start = 0;
+    }
+    if(start + count > set->bits)
+        count = set->bits - start;
+
+    while (count > 0)
+    {
+        int offset = start % BITSET_WORD_BITS;
+        int span = BITSET_WORD_BITS - offset;
+        if(span > count)
+            span = count;
+
+        unsigned int mask = span == BITSET_WORD_BITS ? 0xFFFFFFFFU : ((1U << span) - 1) << offset;
+        if(value)
+            set->words[start / BITSET_WORD_BITS] |= mask;
+        else
+            set->words[start / BITSET_WORD_BITS] &= ~mask;
+
+        start += span;
+        count -= span;
+    }
+}
+
+int popcount(unsigned int word)
+{
+    //Count the bits in parallel, 2 then 4 then 8 bits at a time.
+    word = word - ((word >> 1) & 0x55555555U);
+    word = (word & 0x33333333U) + ((word >> 2) & 0x33333333U);
+    word = (word + (word >> 4)) & 0x0F0F0F0FU;
+    return (int) ((word * 0x01010101U) >> 24);
+}
+
+void bitset_init(bitset_t *set, unsigned int *words, int bits)
+{
+    set->words = words;
+    set->bits = bits;
+    bitset_fill(set, false);
+}
+
+void bitset_set(bitset_t *set, int bit)
+{
+    if(bit < 0 || bit >= set->bits)
+        return;
+    set->words[bit / BITSET_WORD_BITS] |= 1U << (bit % BITSET_WORD_BITS);
+}
+
+void bitset_clear(bitset_t *set, int bit)
+{
+    if(bit < 0 || bit >= set->bits)
+        return;
+    set->words[bit / BITSET_WORD_BITS] &= ~(1U << (bit % BITSET_WORD_BITS));
+}
+
+void bitset_toggle(bitset_t *set, int bit)
+{
+    if(bit < 0 || bit >= set->bits)
+        return;
+    set->words[bit / BITSET_WORD_BITS] ^= 1U << (bit % BITSET_WORD_BITS);
+}
+
+bool bitset_test(const bitset_t *set, int bit)
+{
+    if(bit < 0 || bit >= set->bits)
+        return false;
+    return (set->words[bit / BITSET_WORD_BITS] >> (bit % BITSET_WORD_BITS)) & 1U;
+}
+
+void bitset_assign(bitset_t *set, int bit, bool value)
+{
+    if(value)
+        bitset_set(set, bit);
+    else
+        bitset_clear(set, bit);
+}
+
+void bitset_set_range(bitset_t *set, int start, int count)
+{
+    assign_range(set, start, count, true);
+}
+
+void bitset_clear_range(bitset_t *set, int start, int count)
+{
+    assign_range(set, start, count, false);
+}
+
+void bitset_fill(bitset_t *set, bool value)
+{
+    int words = BITSET_WORDS(set->bits);
+    for (int i = 0; i < words; ++i)
+    {
+        set->words[i] = value ? 0xFFFFFFFFU : 0;
+    }
+
+    //Keep the bits past the end clear so scans and counts can ignore them.
+    if(words > 0)
+        set->words[words - 1] &= last_word_mask(set);
+}
+
+int bitset_find_first_set(const bitset_t *set, int from)
+{
+    if(from < 0)
+        from = 0;
+    if(from >= set->bits)
+        return -1;
+
+    int words = BITSET_WORDS(set->bits);
+    int index = from / BITSET_WORD_BITS;
+
+    //Ignore the bits before 'from' in the first word.
+    unsigned int word = set->words[index] & (0xFFFFFFFFU << (from % BITSET_WORD_BITS));
+    while (true)
+    {
+        if(index == words - 1)
+            word &= last_word_mask(set);
+        if(word != 0)
+            return index * BITSET_WORD_BITS + bit_scan_forward(word);
+
+        if(++index >= words)
+            return -1;
+        word = set->words[index];
+    }
+}
+
+int bitset_find_first_zero(const bitset_t *set, int from)
+{
+    if(from < 0)
+        from = 0;
+    if(from >= set->bits)
+        return -1;
+
+    int words = BITSET_WORDS(set->bits);
+    int index = from / BITSET_WORD_BITS;
+
+    //Scan the inverted words, full words invert to 0 and are skipped.
+    unsigned int word = ~set->words[index] & (0xFFFFFFFFU << (from % BITSET_WORD_BITS));
+    while (true)
+    {
+        if(index == words - 1)
+            word &= last_word_mask(set);
+        if(word != 0)
+            return index * BITSET_WORD_BITS + bit_scan_forward(word);
+
+        if(++index >= words)
+            return -1;
+        word = ~set->words[index];
+    }
+}
+
+int bitset_find_last_set(const bitset_t *set)
+{
+    for (int index = BITSET_WORDS(set->bits) - 1; index >= 0; --index)
+    {
+        unsigned int word = set->words[index];
+        if(index == BITSET_WORDS(set->bits) - 1)
+            word &= last_word_mask(set);
+        if(word != 0)
+            return index * BITSET_WORD_BITS + bit_scan_reverse(word);
+    }
+    return -1;
+}
+
+int bitset_count(const bitset_t *set)
+{
+    int words = BITSET_WORDS(set->bits);
+    int count = 0;
+    for (int i = 0; i < words; ++i)
+    {
+        unsigned int word = set->words[i];
+        if(i == words - 1)
+            word &= last_word_mask(set);
+        count += popcount(word);
+    }
+    return count;
+}
@@ -0,0 +1,142 @@
+#include "deque.h"
+#include "memory.h"
+
+/**
+ * @brief Copies a single element. Elements are small, so a byte loop beats memcpy's temporary buffer.
+ *
+ * @param dst the destination.
+ * @param src the source.
+ * @param n the size of the element.
+ */
+static inline void copy_elem(void *dst, const void *src, size_t n)
+{
+    unsigned char *d = dst;
+    const unsigned char *s = src;
+    for (size_t i = 0; i < n; ++i)
+    {
+        d[i] = s[i];
+    }
+}
+
+/**
+ * @brief Gets the address of the slot at the index, counted from the front, without bounds checking.
+ *
+ * @param deque the deque.
+ * @param index the index.
+ * @return the address of the slot.
+ */
+static inline void *slot_ptr(const deque_t *deque, unsigned int index)
+{
+    unsigned int slot = (deque->head + index) & (deque->capacity - 1);
+    return (unsigned char *) deque->data + slot * deque->elem_size;
+}
+
+bool deque_init(deque_t *deque, size_t elem_size, unsigned int capacity, bool overwrite)
+{
+    unsigned int pow2 = 1;
+    while (pow2 < capacity)
+        pow2 <<= 1;
+
+    void *buffer = sys_alloc_mem(pow2 * elem_size);
+    if(buffer == NULL)
+        return false;
+
+    deque_init_buffer(deque, buffer, elem_size, pow2, overwrite);
+    deque->owns_data = true;
+    return true;
+}
+
+void deque_init_buffer(deque_t *deque, void *buffer, size_t elem_size, unsigned int capacity, bool overwrite)
+{
+    deque->data = buffer;
+    deque->elem_size = elem_size;
+    deque->capacity = capacity;
+    deque->head = deque->size = 0;
+    deque->overwrite = overwrite;
+    deque->owns_data = false;
+}
+
+void deque_destroy(deque_t *deque)
+{
+    if(deque->owns_data && deque->data != NULL)
+        sys_free_mem(deque->data);
+
+    deque->data = NULL;
+    deque->capacity = deque->head = deque->size = 0;
+    deque->owns_data = false;
+}
+
+bool deque_empty(const deque_t *deque)
+{
+    return deque->size == 0;
+}
+
+bool deque_full(const deque_t *deque)
+{
+    return deque->size == deque->capacity;
+}
+
+bool deque_push_back(deque_t *deque, const void *elem)
+{
+    if(deque_full(deque))
+    {
+        if(!deque->overwrite || deque->capacity == 0)
+            return false;
+        deque_pop_front(deque, NULL);
+    }
+
+    copy_elem(slot_ptr(deque, deque->size), elem, deque->elem_size);
+    deque->size++;
+    return true;
+}
+
+bool deque_push_front(deque_t *deque, const void *elem)
+{
+    if(deque_full(deque))
+    {
+        if(!deque->overwrite || deque->capacity == 0)
+            return false;
+        deque_pop_back(deque, NULL);
+    }
+
+    deque->head = (deque->head - 1) & (deque->capacity - 1);
+    deque->size++;
+    copy_elem(slot_ptr(deque, 0), elem, deque->elem_size);
+    return true;
+}
+
+bool deque_pop_front(deque_t *deque, void *out)
+{
+    if(deque->size == 0)
+        return false;
+
+    if(out != NULL)
+        copy_elem(out, slot_ptr(deque, 0), deque->elem_size);
+    deque->head = (deque->head + 1) & (deque->capacity - 1);
+    deque->size--;
+    return true;
+}
+
+bool deque_pop_back(deque_t *deque, void *out)
+{
+    if(deque->size == 0)
+        return false;
+
+    deque->size--;
+    if(out != NULL)
+        copy_elem(out, slot_ptr(deque, deque->size), deque->elem_size);
+    return true;
+}
+
+void *deque_at(const deque_t *deque, unsigned int index)
+{
+    if(index >= deque->size)
+        return NULL;
+
+    return slot_ptr(deque, index);
+}
+
+void deque_clear(deque_t *deque)
+{
+    deque->head = deque->size = 0;
+}
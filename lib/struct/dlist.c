@@ -0,0 +1,99 @@
+#include "dlist.h"
+
+void dlist_init(dlist *list)
+{
+    list->head.prev = list->head.next = &list->head;
+    list->size = 0;
+}
+
+void dlist_node_init(dlist_node *node)
+{
+    node->prev = node->next = NULL;
+}
+
+bool dlist_linked(const dlist_node *node)
+{
+    return node->next != NULL;
+}
+
+bool dlist_empty(const dlist *list)
+{
+    return list->size == 0;
+}
+
+void dlist_insert_before(dlist *list, dlist_node *pos, dlist_node *node)
+{
+    node->next = pos;
+    node->prev = pos->prev;
+    pos->prev->next = node;
+    pos->prev = node;
+    list->size++;
+}
+
+void dlist_push_front(dlist *list, dlist_node *node)
+{
+    dlist_insert_before(list, list->head.next, node);
+}
+
+void dlist_push_back(dlist *list, dlist_node *node)
+{
+    dlist_insert_before(list, &list->head, node);
+}
+
+void dlist_insert_sorted(dlist *list, dlist_node *node, int (*cmp)(dlist_node *, dlist_node *))
+{
+    //Walk backwards past everything that should come after the node.
+    dlist_node *pos = &list->head;
+    while (pos->prev != &list->head && cmp(node, pos->prev) < 0)
+    {
+        pos = pos->prev;
+    }
+    dlist_insert_before(list, pos, node);
+}
+
+void dlist_remove(dlist *list, dlist_node *node)
+{
+    if (!dlist_linked(node))
+        return;
+
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node->next = NULL;
+    list->size--;
+}
+
+dlist_node *dlist_front(const dlist *list)
+{
+    return list->size == 0 ? NULL : list->head.next;
+}
+
+dlist_node *dlist_back(const dlist *list)
+{
+    return list->size == 0 ? NULL : list->head.prev;
+}
+
+dlist_node *dlist_next(const dlist *list, const dlist_node *node)
+{
+    return node->next == &list->head ? NULL : node->next;
+}
+
+dlist_node *dlist_prev(const dlist *list, const dlist_node *node)
+{
+    return node->prev == &list->head ? NULL : node->prev;
+}
+
+dlist_node *dlist_pop_front(dlist *list)
+{
+    dlist_node *node = dlist_front(list);
+    if (node != NULL)
+        dlist_remove(list, node);
+    return node;
+}
+
+dlist_node *dlist_pop_back(dlist *list)
+{
+    dlist_node *node = dlist_back(list);
+    if (node != NULL)
+        dlist_remove(list, node);
+    return node;
+}
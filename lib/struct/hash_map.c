@@ -5,73 +5,158 @@
 #include "hash_map.h"
 #include "memory.h"
 #include "string.h"
+#include <stddef.h>
 
-///A node representing a tombstone.
-static const hash_map_node_t TOMBSTONE_NODE = {0};
 ///The default size of the hash map.
 static const int DEFAULT_CAPACITY = 16;
+///The hash code marking a node as empty.
+#define EMPTY_HASH 0U
 
 /**
- * @brief Double hashes the given key.
+ * @brief Double hashes the given key. The result is never EMPTY_HASH.
  * @param key the key to hash.
  * @return the double hash.
  */
-int double_hash(hash_map_t *map, void *key)
+static unsigned int double_hash(hash_map_t *map, void *key)
 {
-    int hash = map->hash_func(key);
-    return hash ^ ((hash >> 16) & 0xFFFF);
+    //Mix the bits so weak hash functions still spread over the low bits used for indexing.
+    unsigned int hash = (unsigned int) map->hash_func(key);
+    hash ^= hash >> 16;
+    hash *= 0x45D9F3BU;
+    hash ^= hash >> 16;
+    return hash | 0x80000000U;
 }
 
 /**
- * Gets the correct index for the given hash.
+ * @brief Gets the home index for the given hash.
  *
  * @param map the map.
  * @param hash the hash.
  * @return the proper index.
  */
-int get_map_index(hash_map_t *map, int hash)
+static inline int get_map_index(hash_map_t *map, unsigned int hash)
 {
-    int mod = hash % map->capacity;
-    if((hash ^ map->capacity) < 0 && mod != 0)
-        return mod + map->capacity;
-    return mod;
+    return (int) (hash & (unsigned int) (map->capacity - 1));
 }
 
 /**
- * @brief Resizes the given map to the new size. Note that the map's new size MUCH be larger than its old.
+ * @brief Gets how far the node at the index sits from its home index.
  *
  * @param map the map.
- * @param new_size the new size of the map.
+ * @param index the index of the node.
+ * @return the probe distance.
  */
-void resize_map(hash_map_t *map, int new_size)
+static inline int probe_distance(hash_map_t *map, int index)
 {
-    hash_map_node_t **old_items = map->values;
-    int old_capacity = map->capacity;
+    return (index - get_map_index(map, map->values[index].hash_code)) & (map->capacity - 1);
+}
+
+/**
+ * @brief Places a node known not to be in the map, displacing any richer nodes along the way.
+ * The map must have a free slot.
+ *
+ * @param map the map.
+ * @param node the node to insert.
+ */
+static void insert_node(hash_map_t *map, hash_map_node_t node)
+{
+    int mask = map->capacity - 1;
+    int index = get_map_index(map, node.hash_code);
+    int distance = 0;
+    while (true)
+    {
+        hash_map_node_t *slot = &map->values[index];
+        if(slot->hash_code == EMPTY_HASH)
+        {
+            *slot = node;
+            map->size++;
+            return;
+        }
 
-    size_t total_size = sizeof (hash_map_node_t *) * new_size;
-    hash_map_node_t **new_items = sys_alloc_mem(total_size);
+        //Robin Hood: take the slot from a node closer to its home than we are.
+        int slot_distance = probe_distance(map, index);
+        if(slot_distance < distance)
+        {
+            hash_map_node_t displaced = *slot;
+            *slot = node;
+            node = displaced;
+            distance = slot_distance;
+        }
+
+        index = (index + 1) & mask;
+        distance++;
+    }
+}
+
+/**
+ * @brief Finds the index of the node holding the given key.
+ *
+ * @param map the map.
+ * @param key the key.
+ * @param hash_code the hash of the key.
+ * @return the index, or -1 if it's not in the map.
+ */
+static int find_index(hash_map_t *map, void *key, unsigned int hash_code)
+{
+    int mask = map->capacity - 1;
+    int index = get_map_index(map, hash_code);
+    for (int distance = 0; distance < map->capacity; ++distance)
+    {
+        hash_map_node_t *slot = &map->values[index];
+        if(slot->hash_code == EMPTY_HASH)
+            return -1;
+
+        //If the key were here, it would have displaced this node.
+        if(probe_distance(map, index) < distance)
+            return -1;
+
+        if(slot->hash_code == hash_code && map->equality_func(slot->key, key))
+            return index;
+
+        index = (index + 1) & mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief Resizes the given map to the new size. Note that the map's new size MUST be larger than its old.
+ *
+ * @param map the map.
+ * @param new_size the new size of the map, a power of two.
+ * @return true if resized, false if the heap is full.
+ */
+static bool resize_map(hash_map_t *map, int new_size)
+{
+    size_t total_size = sizeof (hash_map_node_t) * new_size;
+    hash_map_node_t *new_items = sys_alloc_mem(total_size);
+    if(new_items == NULL)
+        return false;
     memset(new_items, 0, total_size);
 
-    int old_size = map->size;
+    hash_map_node_t *old_items = map->values;
+    int old_capacity = map->capacity;
     map->values = new_items;
-    map->size = map->contamination = 0;
     map->capacity = new_size;
-    if(old_size > 0)
+    map->size = 0;
+
+    //Move all the old nodes into the new table, then release the old one.
+    if(old_items != NULL)
     {
-        //Put all the old values into the map.
         for (int i = 0; i < old_capacity; ++i)
         {
-            hash_map_node_t *node = old_items[i];
-            if(node == NULL || node == &TOMBSTONE_NODE)
-                continue;
-
-            put(map, node->key, node->value);
+            if(old_items[i].hash_code != EMPTY_HASH)
+                insert_node(map, old_items[i]);
         }
+        sys_free_mem(old_items);
     }
+    return true;
 }
 
 hash_map_t *new_map(bool (*equality_func)(void *value1, void *value2), int (*hash_func)(void *value))
 {
+    if(equality_func == NULL || hash_func == NULL)
+        return NULL;
+
     hash_map_t *allocated = sys_alloc_mem(sizeof (hash_map_t));
     if(allocated == NULL)
     {
@@ -81,100 +166,125 @@ hash_map_t *new_map(bool (*equality_func)(void *value1, void *value2), int (*has
     memset(allocated, 0, sizeof (hash_map_t));
     allocated->equality_func = equality_func;
     allocated->hash_func = hash_func;
-    resize_map(allocated, DEFAULT_CAPACITY);
+    if(!resize_map(allocated, DEFAULT_CAPACITY))
+    {
+        sys_free_mem(allocated);
+        return NULL;
+    }
     return allocated;
 }
 
-void *put(hash_map_t *map, void *key, void *value)
+void destroy_map(hash_map_t *map, bool free_keys, bool free_values)
 {
-    int hash_code = double_hash(map, key);
-    int index = get_map_index(map, hash_code);
+    if(map == NULL)
+        return;
 
-    //Try to find any collisions.
-    int first_tombstone_index = -1;
-    for (int i = 0; i < map->capacity; ++i)
-    {
-        //Get the real index via ASQP
-        int real_index = get_map_index(map, index + (i * i) * (i % 2 == 0 ? -1 : 1));
-        hash_map_node_t *node = map->values[real_index];
+    clear_free(map, free_keys, free_values);
+    sys_free_mem(map->values);
+    sys_free_mem(map);
+}
 
-        //Check for an easy replacement.
-        if(node == NULL)
-        {
-            //In this case, we need to create a new node.
-            hash_map_node_t *new_node = sys_alloc_mem(sizeof (hash_map_node_t));
-            memset(new_node, 0, sizeof (hash_map_node_t));
-            new_node->hash_code = hash_code;
-            new_node->key = key;
-            new_node->value = value;
-            map->values[real_index] = new_node;
-            map->size++;
-            map->contamination++;
-
-            //Check if we should resize.
-            if((float) map->contamination / (float) map->capacity > 0.75F)
-            {
-                int new_capacity = map->capacity * 2;
-                resize_map(map, new_capacity);
-            }
-            return NULL;
-        }
+bool map_reserve(hash_map_t *map, int count)
+{
+    //Keep the load factor at or below 3/4.
+    int new_capacity = map->capacity;
+    while (count * 4 > new_capacity * 3)
+        new_capacity *= 2;
 
-        if(node == &TOMBSTONE_NODE)
-        {
-            if(first_tombstone_index == -1)
-                first_tombstone_index = real_index;
-            continue;
-        }
+    if(new_capacity == map->capacity)
+        return true;
+    return resize_map(map, new_capacity);
+}
 
-        //Check for a replacement.
-        if(node->hash_code == hash_code && map->equality_func(node->key, key))
-        {
-            //We need to replace the first tombstone in this case.
-            void *old_value = node->value;
-            node->key = key;
-            node->value = value;
-            node->hash_code = hash_code;
-            if(first_tombstone_index >= 0)
-            {
-                map->values[real_index] = (hash_map_node_t *) &TOMBSTONE_NODE;
-                map->values[first_tombstone_index] = node;
-            }
-            return old_value;
-        }
+void *put(hash_map_t *map, void *key, void *value)
+{
+    unsigned int hash_code = double_hash(map, key);
+
+    //Check for a replacement.
+    int index = find_index(map, key, hash_code);
+    if(index >= 0)
+    {
+        hash_map_node_t *node = &map->values[index];
+        void *old_value = node->value;
+        node->key = key;
+        node->value = value;
+        return old_value;
     }
 
-    //This should never happen, in theory.
+    //Check if we should resize. If the heap is full we can keep going until the table is.
+    if(!map_reserve(map, map->size + 1) && map->size >= map->capacity)
+        return NULL;
+
+    hash_map_node_t node = {
+            .key = key,
+            .value = value,
+            .hash_code = hash_code
+    };
+    insert_node(map, node);
     return NULL;
 }
 
 void *get(hash_map_t *map, void *key)
 {
-    int hash_code = double_hash(map, key);
-    int index = get_map_index(map, hash_code);
-
-    //Loop through the map, trying to find the item.
-    for (int i = 0; i < map->capacity; ++i)
-    {
-        //Get the index.
-        int real_index = get_map_index(map, index + (i * i) * (i % 2 == 0 ? -1 : 1));
-        hash_map_node_t *node = map->values[real_index];
+    int index = find_index(map, key, double_hash(map, key));
+    return index >= 0 ? map->values[index].value : NULL;
+}
 
-        if(node == NULL)
-            return NULL;
+void *remove_key(hash_map_t *map, void *key)
+{
+    int index = find_index(map, key, double_hash(map, key));
+    if(index < 0)
+        return NULL;
 
-        if(node == &TOMBSTONE_NODE)
-            continue;
+    void *old_value = map->values[index].value;
 
-        if(node->hash_code == hash_code && map->equality_func(node->key, key))
-            return node->value;
+    //Shift the following nodes back until one is empty or already home.
+    int mask = map->capacity - 1;
+    int next = (index + 1) & mask;
+    while (map->values[next].hash_code != EMPTY_HASH && probe_distance(map, next) > 0)
+    {
+        map->values[index] = map->values[next];
+        index = next;
+        next = (next + 1) & mask;
     }
-    return NULL;
+
+    memset(&map->values[index], 0, sizeof (hash_map_node_t));
+    map->size--;
+    return old_value;
 }
 
 bool contains_key(hash_map_t *map, void *key)
 {
-    return get(map, key) != NULL;
+    return find_index(map, key, double_hash(map, key)) >= 0;
+}
+
+hash_map_iter_t map_iterator(hash_map_t *map)
+{
+    hash_map_iter_t iter = {
+            .map = map,
+            .index = -1,
+            .key = NULL,
+            .value = NULL
+    };
+    return iter;
+}
+
+bool map_next(hash_map_iter_t *iter)
+{
+    hash_map_t *map = iter->map;
+    while (++iter->index < map->capacity)
+    {
+        hash_map_node_t *node = &map->values[iter->index];
+        if(node->hash_code == EMPTY_HASH)
+            continue;
+
+        iter->key = node->key;
+        iter->value = node->value;
+        return true;
+    }
+
+    iter->key = iter->value = NULL;
+    return false;
 }
 
 void clear(hash_map_t *map)
@@ -184,21 +294,22 @@ void clear(hash_map_t *map)
 
 void clear_free(hash_map_t *map, bool free_keys, bool free_values)
 {
-    for (int i = 0; i < map->capacity; ++i)
+    if(free_keys || free_values)
     {
-        //Get the node and check if we should free it.
-        hash_map_node_t *node = map->values[i];
-        if(node == NULL || node == &TOMBSTONE_NODE)
-            continue;
-
-        if(free_keys)
-            sys_free_mem(node->key);
-        if(free_values)
-            sys_free_mem(node->value);
+        for (int i = 0; i < map->capacity; ++i)
+        {
+            //Get the node and check if we should free its items.
+            hash_map_node_t *node = &map->values[i];
+            if(node->hash_code == EMPTY_HASH)
+                continue;
 
-        sys_free_mem(node);
+            if(free_keys)
+                sys_free_mem(node->key);
+            if(free_values)
+                sys_free_mem(node->value);
+        }
     }
 
+    memset(map->values, 0, sizeof (hash_map_node_t) * map->capacity);
     map->size = 0;
-    map->contamination = 0;
-}
\ No newline at end of file
+}
@@ -377,6 +377,101 @@ destroy_list(linked_list *to_destroy_ptr, int destroy_values)
     sys_free_mem(to_destroy_ptr);
 }
 
+/**
+ * @brief Merges two sorted runs of nodes into one. Ties are taken from the left run,
+ *        which is what makes the sort stable.
+ * @param left the left run, NULL terminated.
+ * @param right the right run, NULL terminated.
+ * @param cmp the comparison function.
+ * @param tail set to the last node of the merged run.
+ * @return the head of the merged run.
+ */
+static ll_node *merge_runs(ll_node *left, ll_node *right, int (*cmp)(void *, void *), ll_node **tail)
+{
+    ll_node head = {0};
+    ll_node *last = &head;
+    while (left != NULL && right != NULL)
+    {
+        if (cmp(right->_item, left->_item) < 0)
+        {
+            last->_next = right;
+            right = right->_next;
+        }
+        else
+        {
+            last->_next = left;
+            left = left->_next;
+        }
+        last = last->_next;
+    }
+
+    last->_next = left != NULL ? left : right;
+    while (last->_next != NULL)
+        last = last->_next;
+
+    *tail = last;
+    return head._next;
+}
+
+/**
+ * @brief Splits the first run_len nodes off of the given run.
+ * @param node the first node of the run.
+ * @param run_len the amount of nodes to keep.
+ * @return the node following the split, or NULL.
+ */
+static ll_node *split_run(ll_node *node, int run_len)
+{
+    for (int i = 1; node != NULL && i < run_len; ++i)
+        node = node->_next;
+
+    if (node == NULL)
+        return NULL;
+
+    ll_node *rest = node->_next;
+    node->_next = NULL;
+    return rest;
+}
+
+void
+ll_sort(linked_list *list, int (*cmp)(void *, void *))
+{
+    if (list == NULL || list->_size < 2)
+        return;
+
+    if (cmp == NULL)
+        cmp = list->sort_func;
+    if (cmp == NULL)
+        return;
+
+    //Bottom up merge sort, doubling the run length each pass. Nodes are relinked, never copied.
+    ll_node *first = list->_first;
+    ll_node *last = NULL;
+    for (int run_len = 1; run_len < list->_size; run_len *= 2)
+    {
+        ll_node *remaining = first;
+        ll_node *merged_tail = NULL;
+        first = NULL;
+        while (remaining != NULL)
+        {
+            ll_node *left = remaining;
+            ll_node *right = split_run(left, run_len);
+            remaining = split_run(right, run_len);
+
+            ll_node *tail = NULL;
+            ll_node *merged = merge_runs(left, right, cmp, &tail);
+            if (merged_tail == NULL)
+                first = merged;
+            else
+                merged_tail->_next = merged;
+            merged_tail = tail;
+        }
+        last = merged_tail;
+    }
+
+    list->_first = first;
+    list->_last = last;
+}
+
 void ll_clear(linked_list *list)
 {
     ll_clear_free(list, false);
@@ -0,0 +1,178 @@
+#include "pqueue.h"
+#include "memory.h"
+
+///The capacity a queue grows to when it first needs memory.
+#define PQUEUE_MIN_CAPACITY 8
+
+/**
+ * @brief Places the node at the index, updating its stored index.
+ *
+ * @param queue the queue.
+ * @param index the index.
+ * @param node the node.
+ */
+static inline void place(pqueue_t *queue, int index, pq_node *node)
+{
+    queue->nodes[index] = node;
+    node->index = index;
+}
+
+/**
+ * @brief Moves the node at the index towards the root until its parent is no larger.
+ *
+ * @param queue the queue.
+ * @param index the index of the node.
+ */
+static void sift_up(pqueue_t *queue, int index)
+{
+    pq_node *node = queue->nodes[index];
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if(queue->cmp(node, queue->nodes[parent]) >= 0)
+            break;
+
+        place(queue, index, queue->nodes[parent]);
+        index = parent;
+    }
+    place(queue, index, node);
+}
+
+/**
+ * @brief Moves the node at the index towards the leaves until neither child is smaller.
+ *
+ * @param queue the queue.
+ * @param index the index of the node.
+ */
+static void sift_down(pqueue_t *queue, int index)
+{
+    pq_node *node = queue->nodes[index];
+    while (true)
+    {
+        int child = index * 2 + 1;
+        if(child >= queue->size)
+            break;
+
+        //Pick the smaller child.
+        if(child + 1 < queue->size && queue->cmp(queue->nodes[child + 1], queue->nodes[child]) < 0)
+            child++;
+
+        if(queue->cmp(queue->nodes[child], node) >= 0)
+            break;
+
+        place(queue, index, queue->nodes[child]);
+        index = child;
+    }
+    place(queue, index, node);
+}
+
+/**
+ * @brief Grows the node array to the new capacity.
+ *
+ * @param queue the queue.
+ * @param capacity the new capacity.
+ * @return true if successful, false if the heap is full.
+ */
+static bool grow(pqueue_t *queue, int capacity)
+{
+    pq_node **new_nodes = sys_alloc_mem(sizeof (pq_node *) * capacity);
+    if(new_nodes == NULL)
+        return false;
+
+    for (int i = 0; i < queue->size; ++i)
+    {
+        new_nodes[i] = queue->nodes[i];
+    }
+
+    if(queue->nodes != NULL)
+        sys_free_mem(queue->nodes);
+    queue->nodes = new_nodes;
+    queue->capacity = capacity;
+    return true;
+}
+
+bool pq_init(pqueue_t *queue, int (*cmp)(pq_node *, pq_node *), int capacity)
+{
+    queue->nodes = NULL;
+    queue->size = queue->capacity = 0;
+    queue->cmp = cmp;
+    return capacity <= 0 || grow(queue, capacity);
+}
+
+void pq_destroy(pqueue_t *queue)
+{
+    for (int i = 0; i < queue->size; ++i)
+    {
+        queue->nodes[i]->index = -1;
+    }
+
+    if(queue->nodes != NULL)
+        sys_free_mem(queue->nodes);
+    queue->nodes = NULL;
+    queue->size = queue->capacity = 0;
+}
+
+void pq_node_init(pq_node *node)
+{
+    node->index = -1;
+}
+
+bool pq_queued(const pq_node *node)
+{
+    return node->index >= 0;
+}
+
+bool pq_push(pqueue_t *queue, pq_node *node)
+{
+    if(queue->size == queue->capacity)
+    {
+        int new_capacity = queue->capacity < PQUEUE_MIN_CAPACITY ? PQUEUE_MIN_CAPACITY : queue->capacity * 2;
+        if(!grow(queue, new_capacity))
+            return false;
+    }
+
+    place(queue, queue->size++, node);
+    sift_up(queue, node->index);
+    return true;
+}
+
+pq_node *pq_peek(const pqueue_t *queue)
+{
+    return queue->size == 0 ? NULL : queue->nodes[0];
+}
+
+pq_node *pq_pop(pqueue_t *queue)
+{
+    pq_node *top = pq_peek(queue);
+    if(top != NULL)
+        pq_remove(queue, top);
+    return top;
+}
+
+void pq_remove(pqueue_t *queue, pq_node *node)
+{
+    int index = node->index;
+    if(index < 0 || index >= queue->size || queue->nodes[index] != node)
+        return;
+
+    node->index = -1;
+    queue->size--;
+    if(index == queue->size)
+        return;
+
+    //Fill the hole with the last node, which may need to move either way.
+    place(queue, index, queue->nodes[queue->size]);
+    pq_update(queue, queue->nodes[index]);
+}
+
+void pq_update(pqueue_t *queue, pq_node *node)
+{
+    int index = node->index;
+    if(index < 0 || index >= queue->size)
+        return;
+
+    if(index > 0 && queue->cmp(node, queue->nodes[(index - 1) / 2]) < 0)
+        sift_up(queue, index);
+    else
+        sift_down(queue, index);
+}
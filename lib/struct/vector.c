@@ -0,0 +1,131 @@
+#include "vector.h"
+#include "memory.h"
+#include "string.h"
+
+///The capacity a vector grows to when it first needs memory.
+#define VECTOR_MIN_CAPACITY 8
+
+/**
+ * @brief Copies bytes without a temporary buffer, as the elements may be too large for the stack.
+ *
+ * @param dst the destination.
+ * @param src the source, which may not overlap the destination.
+ * @param n the amount of bytes.
+ */
+static void copy_bytes(void *dst, const void *src, size_t n)
+{
+    unsigned char *d = dst;
+    const unsigned char *s = src;
+    for (size_t i = 0; i < n; ++i)
+    {
+        d[i] = s[i];
+    }
+}
+
+/**
+ * @brief Gets the address of the element at the index, without bounds checking.
+ *
+ * @param vec the vector.
+ * @param index the index.
+ * @return the address.
+ */
+static inline void *elem_ptr(vector_t *vec, int index)
+{
+    return (unsigned char *) vec->data + (size_t) index * vec->elem_size;
+}
+
+bool vec_init(vector_t *vec, size_t elem_size, int capacity)
+{
+    vec->data = NULL;
+    vec->elem_size = elem_size;
+    vec->size = 0;
+    vec->capacity = 0;
+    return capacity <= 0 || vec_reserve(vec, capacity);
+}
+
+void vec_destroy(vector_t *vec)
+{
+    if(vec->data != NULL)
+        sys_free_mem(vec->data);
+
+    vec->data = NULL;
+    vec->size = vec->capacity = 0;
+}
+
+bool vec_reserve(vector_t *vec, int capacity)
+{
+    if(capacity <= vec->capacity)
+        return true;
+
+    void *new_data = sys_alloc_mem((size_t) capacity * vec->elem_size);
+    if(new_data == NULL)
+        return false;
+
+    //Move the old elements over and release the old block.
+    if(vec->data != NULL)
+    {
+        copy_bytes(new_data, vec->data, (size_t) vec->size * vec->elem_size);
+        sys_free_mem(vec->data);
+    }
+
+    vec->data = new_data;
+    vec->capacity = capacity;
+    return true;
+}
+
+void *vec_push(vector_t *vec, const void *elem)
+{
+    if(vec->size == vec->capacity)
+    {
+        int new_capacity = vec->capacity < VECTOR_MIN_CAPACITY ? VECTOR_MIN_CAPACITY : vec->capacity * 2;
+        if(!vec_reserve(vec, new_capacity))
+            return NULL;
+    }
+
+    void *slot = elem_ptr(vec, vec->size++);
+    if(elem != NULL)
+        copy_bytes(slot, elem, vec->elem_size);
+    else
+        memset(slot, 0, vec->elem_size);
+    return slot;
+}
+
+bool vec_pop(vector_t *vec, void *out)
+{
+    if(vec->size == 0)
+        return false;
+
+    vec->size--;
+    if(out != NULL)
+        copy_bytes(out, elem_ptr(vec, vec->size), vec->elem_size);
+    return true;
+}
+
+void *vec_at(vector_t *vec, int index)
+{
+    if(index < 0 || index >= vec->size)
+        return NULL;
+
+    return elem_ptr(vec, index);
+}
+
+bool vec_swap_remove(vector_t *vec, int index, void *out)
+{
+    if(index < 0 || index >= vec->size)
+        return false;
+
+    void *slot = elem_ptr(vec, index);
+    if(out != NULL)
+        copy_bytes(out, slot, vec->elem_size);
+
+    //Fill the hole with the last element.
+    vec->size--;
+    if(index != vec->size)
+        copy_bytes(slot, elem_ptr(vec, vec->size), vec->elem_size);
+    return true;
+}
+
+void vec_clear(vector_t *vec)
+{
+    vec->size = 0;
+}
@@ -6,6 +6,7 @@
 #include "stdio.h"
 #include "stddef.h"
 #include "string.h"
+#include "intern.h"
 
 ///The eastern time timezone
 static const time_zone_t ET = {.tz_label = "ET",
@@ -75,20 +76,33 @@ static const time_zone_t *TIMEZONES[] = {
     NULL //For iteration
 };
 
+///The interned labels of the timezones, in the same order as TIMEZONES.
+static symbol_t TIMEZONE_SYMBOLS[sizeof(TIMEZONES) / sizeof(TIMEZONES[0])];
+///If the timezone labels have been interned yet.
+static bool timezones_interned = false;
+
 const time_zone_t **get_all_timezones(void)
 {
     return TIMEZONES;
 }
 
 const time_zone_t *get_timezone(const char *tz_label) {
-    //Iterate over all timezones.
-    int index = 0;
-    while(TIMEZONES[index] != NULL)
+    if(!timezones_interned)
+    {
+        for (int i = 0; TIMEZONES[i] != NULL; ++i)
+            TIMEZONE_SYMBOLS[i] = intern_static_ci(TIMEZONES[i]->tz_label);
+        timezones_interned = true;
+    }
+
+    //A label that was never interned can't be a timezone.
+    symbol_t symbol = find_symbol_ci(tz_label);
+    if(symbol == NULL)
+        return NULL;
+
+    for (int i = 0; TIMEZONES[i] != NULL; ++i)
     {
-        const time_zone_t *tz = TIMEZONES[index];
-        if(strcicmp(tz_label, tz->tz_label) == 0)
-            return tz;
-        index++;
+        if(TIMEZONE_SYMBOLS[i] == symbol)
+            return TIMEZONES[i];
     }
     return NULL;
 }
\ No newline at end of file
@@ -0,0 +1,777 @@
+#include "benchmarks.h"
+#include "stdio.h"
+#include "string.h"
+#include "hash.h"
+#include "math.h"
+#include "linked_list.h"
+#include "pqueue.h"
+#include "vector.h"
+#include "hash_map.h"
+#include "typed_list.h"
+#include "typed_vector.h"
+#include "typed_heap.h"
+#include "typed_map.h"
+#include "mpx/cpu.h"
+#include "sys_req.h"
+#include "mpx/pcb.h"
+#include "mpx/sys_call.h"
+#include "mpx/timer.h"
+
+///The amount of keys used when measuring hash distribution.
+#define DIST_KEYS 192
+///The amount of buckets used when measuring hash distribution, matching a small map.
+#define DIST_BUCKETS 256
+///The amount of iterations for speed measurements.
+#define SPEED_ITERATIONS 10000
+///The amount of items pushed through the ordered queues.
+#define QUEUE_ITEMS 256
+///The amount of system calls timed per request type.
+#define SYSCALL_ITERATIONS 1000
+///How long the mixed load runs for, in milliseconds.
+#define MIXED_LOAD_MS 2000
+///The amount of processes in the mixed load.
+#define MIXED_TASKS 6
+///The frame period of the paced process, in milliseconds.
+#define PACED_PERIOD_MS 50
+///The run time the paced process reserves every frame, in milliseconds.
+#define PACED_BUDGET_MS 20
+///The amount of CPU hogs outranking the paced process.
+#define PACED_HOGS 3
+///The priority of the CPU hogs.
+#define PACED_HOG_PRIORITY 3
+///The priority of the paced process.
+#define PACED_PRIORITY 5
+///The amount of short-lived processes spawned per run of the spawn benchmark.
+#define SPAWN_ITERATIONS 1000
+
+///A single benchmark that can be run by the bench command.
+struct benchmark
+{
+    ///The name used to run the benchmark.
+    const char *label;
+    ///A short description of what is measured.
+    const char *description;
+    ///The function running the benchmark.
+    void (*run)(void);
+};
+
+///Sinks results so the compiler can't drop the work being timed.
+static volatile unsigned int bench_sink;
+///The hashes of the keys being measured.
+static unsigned int dist_hashes[DIST_KEYS];
+///The amount of keys landing in each bucket.
+static unsigned char dist_loads[DIST_BUCKETS];
+///The process-like names used as string keys.
+static char dist_names[DIST_KEYS][12];
+
+///Orders unsigned ints for the typed containers.
+#define uint_cmpr(a, b) ((a) < (b) ? -1 : (a) > (b))
+///Checks if an unsigned int belongs above another in the typed heap.
+#define uint_less(a, b) ((a) < (b))
+///Checks unsigned ints for equality in the typed map.
+#define uint_equals(a, b) ((a) == (b))
+
+DEFINE_VECTOR(uint_vec, unsigned int)
+DEFINE_LIST(uint_list, unsigned int, uint_cmpr)
+DEFINE_HEAP(uint_heap, unsigned int, uint_less)
+DEFINE_HASH_MAP(uint_map, unsigned int, unsigned int, hash_int, uint_equals)
+
+///An item pushed through the ordered queues.
+struct queue_item
+{
+    ///The key the queues order by.
+    unsigned int key;
+    ///The node used by the priority queue.
+    pq_node node;
+};
+///The items pushed through the ordered queues.
+static struct queue_item queue_items[QUEUE_ITEMS];
+
+/**
+ * @brief Divides a cycle count by the amount of operations performed, without 64-bit division.
+ * @param cycles the total cycles.
+ * @param ops the amount of operations.
+ * @return the cycles per operation.
+ */
+static unsigned int cycles_per(unsigned long long cycles, unsigned int ops)
+{
+    while (cycles > 0xFFFFFFFFULL)
+    {
+        cycles >>= 1;
+        ops >>= 1;
+    }
+    return ops == 0 ? 0 : (unsigned int) cycles / ops;
+}
+
+/**
+ * @brief Prints how evenly the measured hashes spread over the buckets, indexing with the low bits.
+ * @param name the name of the hash.
+ */
+static void print_distribution(const char *name)
+{
+    memset(dist_loads, 0, sizeof(dist_loads));
+    int used = 0, max_load = 0;
+    for (int i = 0; i < DIST_KEYS; ++i)
+    {
+        int load = ++dist_loads[dist_hashes[i] & (DIST_BUCKETS - 1)];
+        if(load == 1)
+            used++;
+        if(load > max_load)
+            max_load = load;
+    }
+    printf("  %s: %d/%d buckets used, longest chain %d\n", name, used, DIST_BUCKETS, max_load);
+}
+
+/**
+ * @brief The coordinate hash dragon maze used before hash_coordinate, kept for comparison.
+ * @param x the x component.
+ * @param y the y component.
+ * @return the hash.
+ */
+static unsigned int old_coordinate_hash(int x, int y)
+{
+    return (unsigned int) ((x * 31 + y * 31) * 31);
+}
+
+/**
+ * @brief Measures the distribution and speed of the hash library.
+ */
+static void bench_hash(void)
+{
+    //A random set would spread well with almost any hash, so use the patterned keys the OS actually has.
+    for (int i = 0; i < DIST_KEYS; ++i)
+    {
+        sprintf("proc%d", dist_names[i], sizeof(dist_names[i]), i);
+    }
+
+    println("Distribution of 192 keys into 256 buckets:");
+    for (int i = 0; i < DIST_KEYS; ++i)
+        dist_hashes[i] = hash_string(dist_names[i]);
+    print_distribution("hash_string");
+
+    for (int i = 0; i < DIST_KEYS; ++i)
+        dist_hashes[i] = hash_int((unsigned int) i << 8);
+    print_distribution("hash_int (i << 8)");
+
+    for (int i = 0; i < DIST_KEYS; ++i)
+        dist_hashes[i] = (unsigned int) i << 8;
+    print_distribution("identity (i << 8)");
+
+    for (int i = 0; i < DIST_KEYS; ++i)
+        dist_hashes[i] = hash_coordinate(i % 16, i / 16);
+    print_distribution("hash_coordinate");
+
+    for (int i = 0; i < DIST_KEYS; ++i)
+        dist_hashes[i] = old_coordinate_hash(i % 16, i / 16);
+    print_distribution("old coordinate hash");
+
+    println("Speed:");
+    unsigned long long start = rdtsc();
+    for (int i = 0; i < SPEED_ITERATIONS; ++i)
+        bench_sink = hash_string(dist_names[i % DIST_KEYS]);
+    printf("  %s: %u cycles/hash\n", "hash_string", cycles_per(rdtsc() - start, SPEED_ITERATIONS));
+
+    start = rdtsc();
+    for (int i = 0; i < SPEED_ITERATIONS; ++i)
+        bench_sink = hash_string_ci(dist_names[i % DIST_KEYS]);
+    printf("  %s: %u cycles/hash\n", "hash_string_ci", cycles_per(rdtsc() - start, SPEED_ITERATIONS));
+
+    start = rdtsc();
+    for (int i = 0; i < SPEED_ITERATIONS; ++i)
+        bench_sink = hash_int((unsigned int) i);
+    printf("  %s: %u cycles/hash\n", "hash_int", cycles_per(rdtsc() - start, SPEED_ITERATIONS));
+
+    start = rdtsc();
+    for (int i = 0; i < SPEED_ITERATIONS; ++i)
+        bench_sink = hash_coordinate(i & 0x7F, i >> 7);
+    printf("  %s: %u cycles/hash\n", "hash_coordinate", cycles_per(rdtsc() - start, SPEED_ITERATIONS));
+}
+
+/**
+ * @brief Compares queue items for the sorted linked list.
+ * @param item1 the first item.
+ * @param item2 the second item.
+ * @return the comparison value of the two items.
+ */
+static int queue_item_cmpr(void *item1, void *item2)
+{
+    unsigned int key1 = ((struct queue_item *) item1)->key;
+    unsigned int key2 = ((struct queue_item *) item2)->key;
+    return key1 < key2 ? -1 : key1 > key2;
+}
+
+/**
+ * @brief Compares queue items for the priority queue.
+ * @param node1 the first item's node.
+ * @param node2 the second item's node.
+ * @return the comparison value of the two items.
+ */
+static int queue_node_cmpr(pq_node *node1, pq_node *node2)
+{
+    return queue_item_cmpr(container_of(node1, struct queue_item, node), container_of(node2, struct queue_item, node));
+}
+
+/**
+ * @brief Compares a sorted linked list against the binary heap for ordered insert and removal.
+ */
+static void bench_pqueue(void)
+{
+    rand_state_t rand;
+    rand_seed(&rand, QUEUE_ITEMS);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+    {
+        queue_items[i].key = rand_next(&rand);
+        pq_node_init(&queue_items[i].node);
+    }
+
+    linked_list *list = nl_unbounded();
+    pqueue_t queue;
+    if(list == NULL || !pq_init(&queue, &queue_node_cmpr, QUEUE_ITEMS))
+    {
+        println("Not enough memory to run the benchmark!");
+        if(list != NULL)
+            destroy_list(list, false);
+        return;
+    }
+    set_sort_func(list, &queue_item_cmpr);
+
+    printf("%d random keys pushed, then popped in order:\n", QUEUE_ITEMS);
+    unsigned long long start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        add_item(list, &queue_items[i]);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        remove_item_unsafe(list, 0);
+    printf("  sorted linked_list: %u cycles/item\n", cycles_per(rdtsc() - start, QUEUE_ITEMS));
+
+    //The same keys added unsorted, then merge sorted once.
+    set_sort_func(list, NULL);
+    start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        add_item(list, &queue_items[i]);
+    ll_sort(list, &queue_item_cmpr);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        remove_item_unsafe(list, 0);
+    printf("  linked_list + ll_sort: %u cycles/item\n", cycles_per(rdtsc() - start, QUEUE_ITEMS));
+
+    start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        pq_push(&queue, &queue_items[i].node);
+    unsigned int last = 0;
+    bool ordered = true;
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+    {
+        unsigned int key = pq_entry(pq_pop(&queue), struct queue_item, node)->key;
+        ordered = ordered && key >= last;
+        last = key;
+    }
+    printf("  pqueue: %u cycles/item%s\n", cycles_per(rdtsc() - start, QUEUE_ITEMS), ordered ? "" : " (OUT OF ORDER!)");
+
+    destroy_list(list, false);
+    pq_destroy(&queue);
+}
+
+/**
+ * @brief Hashes an integer stored directly in a generic map key.
+ * @param key the key.
+ * @return the hash.
+ */
+static int uint_key_hash(void *key)
+{
+    return (int) hash_int((unsigned int) (size_t) key);
+}
+
+/**
+ * @brief Compares integers stored directly in generic map keys.
+ * @param key1 the first key.
+ * @param key2 the second key.
+ * @return true if they are equal.
+ */
+static bool uint_key_equals(void *key1, void *key2)
+{
+    return key1 == key2;
+}
+
+/**
+ * @brief Prints the cycles per item of a generic container next to its typed version.
+ * @param name the name of the container.
+ * @param generic the cycles taken by the generic container.
+ * @param typed the cycles taken by the typed container.
+ */
+static void print_container_result(const char *name, unsigned long long generic, unsigned long long typed)
+{
+    printf("  %s: generic %u, typed %u cycles/item\n", name, cycles_per(generic, QUEUE_ITEMS), cycles_per(typed, QUEUE_ITEMS));
+}
+
+/**
+ * @brief Compares the void pointer containers against the macro generated, type specialized ones.
+ */
+static void bench_containers(void)
+{
+    rand_state_t rand;
+    rand_seed(&rand, QUEUE_ITEMS);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+    {
+        queue_items[i].key = rand_next(&rand);
+        pq_node_init(&queue_items[i].node);
+    }
+    printf("%d random keys per container:\n", QUEUE_ITEMS);
+
+    //Vector: push every key, then sum them.
+    vector_t vec;
+    uint_vec_t typed_vec;
+    if(!vec_init(&vec, sizeof(unsigned int), 0) || !uint_vec_init(&typed_vec, 0))
+    {
+        vec_destroy(&vec);
+        println("Not enough memory to run the benchmark!");
+        return;
+    }
+    unsigned long long start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        vec_push(&vec, &queue_items[i].key);
+    unsigned int sum = 0;
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        sum += *(unsigned int *) vec_at(&vec, i);
+    unsigned long long generic = rdtsc() - start;
+    start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        uint_vec_push(&typed_vec, queue_items[i].key);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        sum -= *uint_vec_at(&typed_vec, i);
+    print_container_result("vector push + read", generic, rdtsc() - start);
+    bench_sink = sum;
+    vec_destroy(&vec);
+    uint_vec_destroy(&typed_vec);
+
+    //Sorted list: insert every key in order, then pop them.
+    linked_list *list = nl_unbounded();
+    if(list == NULL)
+    {
+        println("Not enough memory to run the benchmark!");
+        return;
+    }
+    set_sort_func(list, &queue_item_cmpr);
+    start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        add_item(list, &queue_items[i]);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        remove_item_unsafe(list, 0);
+    generic = rdtsc() - start;
+    destroy_list(list, false);
+
+    uint_list_t typed_list;
+    uint_list_init(&typed_list);
+    start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        uint_list_insert_sorted(&typed_list, queue_items[i].key);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        uint_list_pop_front(&typed_list, NULL);
+    print_container_result("sorted list", generic, rdtsc() - start);
+    uint_list_destroy(&typed_list);
+
+    //Heap: push every key, then pop them in order.
+    pqueue_t queue;
+    uint_heap_t typed_heap;
+    if(!pq_init(&queue, &queue_node_cmpr, QUEUE_ITEMS) || !uint_heap_init(&typed_heap, QUEUE_ITEMS))
+    {
+        pq_destroy(&queue);
+        println("Not enough memory to run the benchmark!");
+        return;
+    }
+    start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        pq_push(&queue, &queue_items[i].node);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        pq_pop(&queue);
+    generic = rdtsc() - start;
+    start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        uint_heap_push(&typed_heap, queue_items[i].key);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        uint_heap_pop(&typed_heap, NULL);
+    print_container_result("heap", generic, rdtsc() - start);
+    pq_destroy(&queue);
+    uint_heap_destroy(&typed_heap);
+
+    //Hash map: put every key, then look each one up.
+    hash_map_t *map = new_map(&uint_key_equals, &uint_key_hash);
+    uint_map_t typed_map;
+    if(map == NULL || !uint_map_init(&typed_map))
+    {
+        destroy_map(map, false, false);
+        println("Not enough memory to run the benchmark!");
+        return;
+    }
+    start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        put(map, (void *) (size_t) queue_items[i].key, &queue_items[i]);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        bench_sink = ((struct queue_item *) get(map, (void *) (size_t) queue_items[i].key))->key;
+    generic = rdtsc() - start;
+    start = rdtsc();
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        uint_map_put(&typed_map, queue_items[i].key, (unsigned int) i);
+    for (int i = 0; i < QUEUE_ITEMS; ++i)
+        bench_sink = *uint_map_get(&typed_map, queue_items[i].key);
+    print_container_result("hash map put + get", generic, rdtsc() - start);
+    destroy_map(map, false, false);
+    uint_map_destroy(&typed_map);
+}
+
+/**
+ * @brief Times system call round trips. Requests the kernel answers right away return without going through
+ * the scheduler, while IDLE always does.
+ */
+static void bench_syscall(void)
+{
+    char buffer[1];
+
+    //Zero length requests are rejected without touching the device.
+    unsigned long long start = rdtsc();
+    for (int i = 0; i < SYSCALL_ITERATIONS; ++i)
+        bench_sink = (unsigned int) sys_req(WRITE, COM1, buffer, 0);
+    printf("  rejected WRITE: %u cycles/call\n", cycles_per(rdtsc() - start, SYSCALL_ITERATIONS));
+
+    start = rdtsc();
+    for (int i = 0; i < SYSCALL_ITERATIONS; ++i)
+        bench_sink = (unsigned int) sys_req(IDLE);
+    printf("  IDLE: %u cycles/call\n", cycles_per(rdtsc() - start, SYSCALL_ITERATIONS));
+}
+
+///A process of the mixed load.
+struct mixed_task
+{
+    ///The name of the process.
+    const char *name;
+    ///The priority of the process.
+    int priority;
+    ///The function the process runs, given its slot in the results.
+    void (*run)(int slot);
+};
+
+///What a mixed load process measured about itself right before exiting.
+struct mixed_result
+{
+    ///The longest it waited in a ready queue, in ticks.
+    unsigned int max_wait_ticks;
+    ///The total time it waited in a ready queue, in ticks.
+    unsigned int total_wait_ticks;
+    ///The amount of times it was dispatched after waiting.
+    unsigned int waits;
+    ///Whether the process has exited.
+    bool done;
+};
+
+///The results of the mixed load processes.
+static volatile struct mixed_result mixed_results[MIXED_TASKS];
+///The tick the mixed load processes stop at.
+static unsigned long long mixed_end_tick;
+
+/**
+ * @brief Records the running mixed load process' wait times, then exits it.
+ * @param slot the process' slot in the results.
+ */
+static void mixed_finish(int slot)
+{
+    struct pcb_stats *stats = &get_active_pcb()->stats;
+    mixed_results[slot].max_wait_ticks = stats->max_wait_ticks;
+    mixed_results[slot].total_wait_ticks = stats->total_wait_ticks;
+    mixed_results[slot].waits = stats->waits;
+    mixed_results[slot].done = true;
+    sys_req(EXIT);
+}
+
+/**
+ * @brief A CPU hog, spinning until the mixed load ends without ever giving up the CPU.
+ * @param slot the process' slot in the results.
+ */
+static void mixed_hog(int slot)
+{
+    while (get_timer_ticks() < mixed_end_tick)
+        bench_sink++;
+    mixed_finish(slot);
+}
+
+/**
+ * @brief A process yielding over and over, which strict priorities let starve everything below it.
+ * @param slot the process' slot in the results.
+ */
+static void mixed_yielder(int slot)
+{
+    while (get_timer_ticks() < mixed_end_tick)
+        sys_req(IDLE);
+    mixed_finish(slot);
+}
+
+/**
+ * @brief An IO bound process, sleeping most of the time and doing a tick of work when it wakes.
+ * @param slot the process' slot in the results.
+ */
+static void mixed_io(int slot)
+{
+    while (get_timer_ticks() < mixed_end_tick)
+    {
+        sys_req(SLEEP, 20);
+        unsigned long long next_tick = get_timer_ticks() + 1;
+        while (get_timer_ticks() < next_tick)
+            bench_sink++;
+    }
+    mixed_finish(slot);
+}
+
+///The processes of the mixed load.
+static const struct mixed_task mixed_tasks[MIXED_TASKS] = {
+        {.name = "yielder", .priority = 1, .run = &mixed_yielder},
+        {.name = "io1", .priority = 3, .run = &mixed_io},
+        {.name = "hog1", .priority = 5, .run = &mixed_hog},
+        {.name = "hog2", .priority = 5, .run = &mixed_hog},
+        {.name = "io2", .priority = 6, .run = &mixed_io},
+        {.name = "low", .priority = 8, .run = &mixed_hog},
+};
+
+/**
+ * @brief Runs the mixed load under the given policy, then prints how long each process waited to run.
+ * @param policy the scheduling policy.
+ * @param label the name of the policy.
+ */
+static void run_mixed_load(enum sched_policy policy, const char *label)
+{
+    set_sched_policy(policy);
+    mixed_end_tick = get_timer_ticks() + ms_to_ticks(MIXED_LOAD_MS);
+    for (int i = 0; i < MIXED_TASKS; ++i)
+    {
+        mixed_results[i].done = false;
+        if(!generate_new_pcb(mixed_tasks[i].name, mixed_tasks[i].priority, USER, mixed_tasks[i].run,
+                             (char *) &i, sizeof(int), 0, PCB_SMALL_STACK_SIZE))
+        {
+            printf("  Failed to start '%s'! (Heap may be full!)\n", mixed_tasks[i].name);
+            mixed_results[i].done = true;
+            mixed_results[i].waits = 0;
+        }
+    }
+
+    //Wait for every process to exit.
+    for (int i = 0; i < MIXED_TASKS; ++i)
+    {
+        while (!mixed_results[i].done)
+            sys_req(SLEEP, 100);
+    }
+
+    printf("  %s:\n", label);
+    unsigned int worst = 0;
+    for (int i = 0; i < MIXED_TASKS; ++i)
+    {
+        unsigned int waits = mixed_results[i].waits;
+        unsigned int average = waits == 0 ? 0 : mixed_results[i].total_wait_ticks / waits;
+        if(mixed_results[i].max_wait_ticks > worst)
+            worst = mixed_results[i].max_wait_ticks;
+        printf("    %s (priority %d): worst wait %ums, average wait %ums over %u dispatches\n", mixed_tasks[i].name,
+               mixed_tasks[i].priority, ticks_to_ms(mixed_results[i].max_wait_ticks), ticks_to_ms(average), waits);
+    }
+    printf("    worst wait overall: %ums\n", ticks_to_ms(worst));
+}
+
+/**
+ * @brief Runs a mixed load of CPU hogs, IO bound processes and a yielding high priority process under both
+ * scheduling policies, comparing how long the processes waited to run.
+ */
+static void bench_sched(void)
+{
+    enum sched_policy previous = get_sched_policy();
+    run_mixed_load(SCHED_STRICT, "strict");
+    run_mixed_load(SCHED_FAIR, "fair");
+    set_sched_policy(previous);
+}
+
+///Whether the paced process asks for a real-time reservation.
+static bool paced_realtime;
+///The latest the paced process started a frame, in ticks.
+static volatile unsigned int paced_max_late;
+///The total time the paced process started its frames late, in ticks.
+static volatile unsigned int paced_total_late;
+///The amount of frames the paced process ran.
+static volatile unsigned int paced_frames;
+///Whether the paced process has exited.
+static volatile bool paced_done;
+
+/**
+ * @brief A process drawing frames at a fixed rate, recording how late each frame started.
+ */
+static void paced_process(void)
+{
+    if(paced_realtime && !pcb_set_realtime(get_active_pcb(), PACED_PERIOD_MS, PACED_BUDGET_MS))
+        println("  The real-time reservation was rejected!");
+
+    unsigned int period = ms_to_ticks(PACED_PERIOD_MS);
+    unsigned long long frame = get_timer_ticks();
+    while (frame < mixed_end_tick)
+    {
+        frame += period;
+        sys_req(SLEEP_UNTIL, frame);
+
+        unsigned int late = (unsigned int) (get_timer_ticks() - frame);
+        if(late > paced_max_late)
+            paced_max_late = late;
+        paced_total_late += late;
+        paced_frames++;
+
+        //A little work for the frame.
+        for (int i = 0; i < 10000; ++i)
+            bench_sink++;
+    }
+    paced_done = true;
+    sys_req(EXIT);
+}
+
+/**
+ * @brief Runs the paced process behind higher priority CPU hogs, then prints how late its frames started.
+ * @param realtime whether the paced process reserves its time.
+ * @param label the name of the run.
+ */
+static void run_paced_load(bool realtime, const char *label)
+{
+    paced_realtime = realtime;
+    paced_max_late = paced_total_late = paced_frames = 0;
+    paced_done = false;
+    mixed_end_tick = get_timer_ticks() + ms_to_ticks(MIXED_LOAD_MS);
+
+    char name[PCB_MAX_NAME_LEN + 1];
+    for (int i = 0; i < PACED_HOGS; ++i)
+    {
+        mixed_results[i].done = false;
+        if(!generate_new_pcb(sprintf("hog%d", name, sizeof(name), i), PACED_HOG_PRIORITY, USER, &mixed_hog,
+                             (char *) &i, sizeof(int), 0, PCB_SMALL_STACK_SIZE))
+            mixed_results[i].done = true;
+    }
+    if(!generate_new_pcb("paced", PACED_PRIORITY, USER, &paced_process, NULL, 0, 0, PCB_SMALL_STACK_SIZE))
+    {
+        println("  Failed to start the paced process! (Heap may be full!)");
+        paced_done = true;
+    }
+
+    //Wait for every process to exit.
+    for (int i = 0; i < PACED_HOGS; ++i)
+    {
+        while (!mixed_results[i].done)
+            sys_req(SLEEP, 100);
+    }
+    while (!paced_done)
+        sys_req(SLEEP, 100);
+
+    unsigned int average = paced_frames == 0 ? 0 : paced_total_late / paced_frames;
+    printf("  %s: %u frames, latest %ums, average %ums late\n", label, paced_frames, ticks_to_ms(paced_max_late),
+           ticks_to_ms(average));
+}
+
+/**
+ * @brief Runs a process pacing frames behind higher priority CPU hogs, once at its priority and once with a
+ * real-time reservation, comparing how late the frames started.
+ */
+static void bench_edf(void)
+{
+    run_paced_load(false, "priority");
+    run_paced_load(true, "real-time");
+}
+
+///The amount of spawned processes that ran to their exit.
+static volatile unsigned int spawn_exits;
+
+/**
+ * @brief A short-lived process, exiting as soon as it runs.
+ */
+static void spawn_process(void)
+{
+    spawn_exits++;
+    sys_req(EXIT);
+}
+
+/**
+ * @brief Spawns short-lived processes one after another, each exiting before the next one is spawned.
+ * @param label the name of the run.
+ */
+static void run_spawns(const char *label)
+{
+    //Spawned at the caller's priority, so yielding lets each one run straight away.
+    struct pcb *self = get_active_pcb();
+    int priority = self == NULL ? 0 : self->priority;
+    spawn_exits = 0;
+
+    unsigned int spawned = 0;
+    unsigned long long start = rdtsc();
+    for (; spawned < SPAWN_ITERATIONS; ++spawned)
+    {
+        if(!generate_new_pcb("spawn", priority, USER, &spawn_process, NULL, 0, 0, PCB_SMALL_STACK_SIZE))
+            break;
+        while (spawn_exits <= spawned)
+            sys_req(IDLE);
+    }
+    unsigned long long cycles = rdtsc() - start;
+
+    if(spawned < SPAWN_ITERATIONS)
+        printf("  %s: failed after %u processes! (Heap may be full!)\n", label, spawned);
+    else
+        printf("  %s: %u cycles per spawn and exit\n", label, cycles_per(cycles, spawned));
+}
+
+/**
+ * @brief Measures spawn and exit throughput, with exited PCBs freed and with them pooled for reuse.
+ */
+static void bench_spawn(void)
+{
+    bool pooled = set_pcb_pool_enabled(false);
+    run_spawns("freed");
+    set_pcb_pool_enabled(true);
+    run_spawns("pooled");
+    set_pcb_pool_enabled(pooled);
+}
+
+///All benchmarks, terminated with NULL.
+static const struct benchmark benchmarks[] = {
+        {.label = "hash", .description = "Hash function distribution and speed", .run = &bench_hash},
+        {.label = "pqueue", .description = "Sorted linked list against the binary heap", .run = &bench_pqueue},
+        {.label = "containers", .description = "Generic containers against the type specialized ones", .run = &bench_containers},
+        {.label = "syscall", .description = "System call round trips, with and without the scheduler", .run = &bench_syscall},
+        {.label = "sched", .description = "Wait times of a mixed load under strict and fair scheduling", .run = &bench_sched},
+        {.label = "edf", .description = "Frame lateness behind CPU hogs, with and without a real-time reservation", .run = &bench_edf},
+        {.label = "spawn", .description = "Spawn and exit throughput, with and without the PCB pool", .run = &bench_spawn},
+        {.label = NULL},
+};
+
+bool cmd_bench(const char *comm)
+{
+    if(!first_label_matches(comm, CMD_BENCH_LABEL))
+        return false;
+
+    //Create a copy.
+    size_t str_len = strlen(comm);
+    char comm_cpy[str_len + 1];
+    memcpy(comm_cpy, comm, str_len + 1);
+
+    //Skip over the label.
+    strtok(comm_cpy, " ");
+    char *name = strtok(NULL, " ");
+    if(name == NULL)
+    {
+        println("Available benchmarks, run one with 'bench (name)' or all with 'bench all':");
+        for (int i = 0; benchmarks[i].label != NULL; ++i)
+        {
+            printf("=> %s - %s\n", benchmarks[i].label, benchmarks[i].description);
+        }
+        return true;
+    }
+
+    bool run_all = strcicmp(name, "all") == 0;
+    bool found = false;
+    for (int i = 0; benchmarks[i].label != NULL; ++i)
+    {
+        if(!run_all && strcicmp(name, benchmarks[i].label) != 0)
+            continue;
+
+        printf("Running '%s'...\n", benchmarks[i].label);
+        benchmarks[i].run();
+        found = true;
+    }
+
+    if(!found)
+        printf("Unknown benchmark '%s'! Type 'bench' to list them.\n", name);
+    return true;
+}
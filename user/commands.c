@@ -15,6 +15,8 @@
 #include "mpx/alarm.h"
 #include "mpx/heap.h"
 #include "math.h"
+#include "benchmarks.h"
+#include "intern.h"
 
 #define CMD_HELP_LABEL "help"
 #define CMD_VERSION_LABEL "version"
@@ -60,9 +62,17 @@ static const char *CMD_LABELS[] = {
         CMD_SHOW_FREE,
         CMD_DRAGONMAZE,
         CMD_MINESWEEPER,
+        CMD_BENCH_LABEL,
+        CMD_TOP_LABEL,
+        CMD_SCHED_LABEL,
         NULL,
 };
 
+///The interned command labels, in the same order as CMD_LABELS.
+static symbol_t CMD_SYMBOLS[sizeof(CMD_LABELS) / sizeof(CMD_LABELS[0])];
+///If the command labels have been interned yet.
+static bool cmds_interned = false;
+
 const char *find_best_match(const char *cmd)
 {
     const char *best_match = NULL;
@@ -83,12 +93,34 @@ const char *find_best_match(const char *cmd)
 
 bool command_exists(const char *cmd)
 {
-    int index = 0;
-    while(CMD_LABELS[index] != NULL)
+    if(!cmds_interned)
+    {
+        for (int i = 0; CMD_LABELS[i] != NULL; ++i)
+            CMD_SYMBOLS[i] = intern_static_ci(CMD_LABELS[i]);
+        cmds_interned = true;
+    }
+
+    //Copy out only the first word, this is called on every keystroke.
+    while(*cmd == ' ')
+        cmd++;
+    size_t label_len = 0;
+    while(cmd[label_len] != '\0' && cmd[label_len] != ' ')
+        label_len++;
+    if(label_len == 0)
+        return false;
+
+    char label[label_len + 1];
+    memcpy(label, cmd, label_len);
+    label[label_len] = '\0';
+
+    symbol_t symbol = find_symbol_ci(label);
+    if(symbol == NULL)
+        return false;
+
+    for (int i = 0; CMD_LABELS[i] != NULL; ++i)
     {
-        if(first_label_matches(cmd, CMD_LABELS[index]))
+        if(CMD_SYMBOLS[i] == symbol)
             return true;
-        index++;
     }
     return false;
 }
@@ -398,7 +430,7 @@ struct help_info help_messages[] = {
         {.str_label = {CMD_COLOR_LABEL},
                 .help_message = "The '%s' command sets the color of text output.\nto change your color, enter 'color'"},
         {.str_label = {CMD_PCB_LABEL},
-                .help_message = "The '%s' command shows all the pcb commands available to the user. the help commands are listed below\n=> enter 'help pcb delete'\n=> enter 'help pcb suspend'\n=> enter 'help pcb resume'\n=> enter 'help pcb priority'\n=> enter 'help pcb show'\n=> enter 'help pcb show-ready'\n=> enter 'help pcb show-blocked'\n=> enter 'help pcb show-all'"},
+                .help_message = "The '%s' command shows all the pcb commands available to the user. the help commands are listed below\n=> enter 'help pcb delete'\n=> enter 'help pcb suspend'\n=> enter 'help pcb resume'\n=> enter 'help pcb priority'\n=> enter 'help pcb realtime'\n=> enter 'help pcb show'\n=> enter 'help pcb show-ready'\n=> enter 'help pcb show-blocked'\n=> enter 'help pcb show-all'"},
         {.str_label = {CMD_PCB_LABEL, "delete"},
                 .help_message = "The '%s' Command Deletes the process and frees all associated memory"},
         {.str_label = {CMD_PCB_LABEL, "suspend"},
@@ -407,6 +439,8 @@ struct help_info help_messages[] = {
                 .help_message = "The '%s' Command resumes the process after its been suspended"},
         {.str_label = {CMD_PCB_LABEL, "priority"},
                 .help_message = "The '%s' Command changes the process's priority"},
+        {.str_label = {CMD_PCB_LABEL, "realtime"},
+                .help_message = "The '%s' Command reserves CPU time for the process every period, running it ahead of every priority by earliest deadline.\n=> enter 'pcb realtime (name) (period ms) (budget ms)' to make it real-time\n=> enter 'pcb realtime (name) off' to make it a normal process again"},
         {.str_label = {CMD_PCB_LABEL, "show"},
                 .help_message = "The '%s' Command displays the process's info including name, class, state, status, and priority"},
         {.str_label = {CMD_PCB_LABEL, "show-ready"},
@@ -419,6 +453,12 @@ struct help_info help_messages[] = {
             .help_message = "The '%s' Command will start up the dragonmaze game. Using W A S D you can manuver the character to try and save the princess, but beware of the dragon."},
         {.str_label = {CMD_MINESWEEPER},
             .help_message = "The '%s' Command will start up a fresh game of classic minesweeper. \nUsing W A S D to move, you can use the spacebar to blow up squares, and [f] to flag potential mines."},
+        {.str_label = {CMD_BENCH_LABEL},
+            .help_message = "The '%s' Command runs the built in benchmarks.\n=> enter 'bench' to list them\n=> enter 'bench (name)' to run one\n=> enter 'bench all' to run all of them"},
+        {.str_label = {CMD_TOP_LABEL},
+            .help_message = "The '%s' Command shows the processes sorted by CPU usage, along with the load averages.\n=> enter 'top' to refresh it 5 times, a second apart\n=> enter 'top (count)' to refresh it count times"},
+        {.str_label = {CMD_SCHED_LABEL},
+            .help_message = "The '%s' Command shows the scheduling policy and how long each process waited to run.\n=> enter 'sched strict' to always run the highest priority process first\n=> enter 'sched fair' to boost processes that waited long and decay ones hogging the CPU"},
 
 };
 
@@ -507,6 +547,9 @@ bool cmd_help(const char *comm)
     println("=> enter 'help show-free");
     println("=> enter 'help dragonmaze'");
     println("=> enter 'help minesweeper'");
+    println("=> enter 'help bench'");
+    println("=> enter 'help top'");
+    println("=> enter 'help sched'");
     return true;
 }
 
@@ -5,11 +5,19 @@
 #include "bomb_catcher.h"
 #include "stdio.h"
 #include "stdbool.h"
+#include "sys_req.h"
+#include "mpx/pcb.h"
+#include "mpx/sys_call.h"
+#include "mpx/timer.h"
 
 ///The width of the game screen
 #define SCREEN_WIDTH 30
 ///The height of the game screen
 #define SCREEN_HEIGHT 10
+///The length of a frame, in milliseconds.
+#define FRAME_MS 100
+///The run time reserved for drawing each frame, in milliseconds.
+#define FRAME_BUDGET_MS 20
 
 ///Denotes the game being in an active state.
 static bool game_active = false;
@@ -20,11 +28,14 @@ static int time = 0;
 
 ///The position of the catcher.
 static int catcher_pos = 0;
+///The tick the next frame starts at.
+static unsigned long long next_frame = 0;
 
-///Stalls CPU time by spinning on a for loop.
+///Waits for the next frame, sleeping so other processes get the time in between.
 void stall(void)
 {
-    for (int i = 0; i < 100000000; ++i);
+    next_frame += ms_to_ticks(FRAME_MS);
+    sys_req(SLEEP_UNTIL, next_frame);
 }
 
 ///Resets the game to its initial state.
@@ -77,8 +88,16 @@ void start_bombcatcher(void)
     reset();
     game_active = true;
 
+    //Frames are paced by a real-time reservation, so background load can't make the game stutter.
+    struct pcb *self = get_active_pcb();
+    bool paced = self != NULL && pcb_set_realtime(self, FRAME_MS, FRAME_BUDGET_MS);
+    next_frame = get_timer_ticks();
+
     while(game_active) {
         stall();
         game_tick();
     }
+
+    if(paced)
+        pcb_set_realtime(self, 0, 0);
 }
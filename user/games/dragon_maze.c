@@ -6,6 +6,9 @@
 #include "stdbool.h"
 #include "stdio.h"
 #include "hash_map.h"
+#include "hash.h"
+#include "vector.h"
+#include "bitset.h"
 #include "linked_list.h"
 #include "math.h"
 #include "memory.h"
@@ -163,7 +166,7 @@ bool is_wall(char c)
  */
 int coordinate_hash(coordinate_t *coordinate)
 {
-    return (coordinate->x * 31 + coordinate->y * 31) * 31;
+    return (int) hash_coordinate(coordinate->x, coordinate->y);
 }
 
 ///The maze board struct.
@@ -195,8 +198,33 @@ static maze_board_t board;
 ///A list used to 'inform' the player of something happening.
 static linked_list *inform_list;
 
+///The words backing the visited map.
+static unsigned int visited_words[BITSET_WORDS(MAZE_HEIGHT * MAZE_LENGTH)];
 ///The map to use for visited tiles in maze generation. It's also used for the 'discovered' tiles in harder difficulties.
-static bool visited_map[MAZE_HEIGHT][MAZE_LENGTH] = {{0}};
+static bitset_t visited_map = BITSET_INIT(visited_words, MAZE_HEIGHT * MAZE_LENGTH);
+
+/**
+ * @brief Marks the given location as visited.
+ * @param location the location.
+ */
+static inline void mark_visited(coordinate_t location)
+{
+    if(location.x < 0 || location.x >= MAZE_LENGTH)
+        return;
+    bitset_set(&visited_map, location.y * MAZE_LENGTH + location.x);
+}
+
+/**
+ * @brief Checks if the given location has been visited.
+ * @param location the location.
+ * @return true if it has been visited.
+ */
+static inline bool was_visited(coordinate_t location)
+{
+    if(location.x < 0 || location.x >= MAZE_LENGTH)
+        return false;
+    return bitset_test(&visited_map, location.y * MAZE_LENGTH + location.x);
+}
 
 /**
  * @brief Sets the given piece at the given location.
@@ -251,22 +279,22 @@ void add_renderable_positions(void)
             char at_loc = get_piece(current);
             if(is_wall(at_loc) || at_loc == FINISH)
             {
-                visited_map[current.y][current.x] = true;
+                mark_visited(current);
 
                 //Spread out against the wall if necessary.
                 if(at_loc == VERTICAL_WALL)
                 {
                     coordinate_t wall_up = shift(current, W, 1);
                     coordinate_t wall_down = shift(current, S, 1);
-                    visited_map[wall_up.y][wall_up.x] = true;
-                    visited_map[wall_down.y][wall_down.x] = true;
+                    mark_visited(wall_up);
+                    mark_visited(wall_down);
                 }
                 else if(at_loc == HORIZONTAL_WALL)
                 {
                     coordinate_t wall_left = shift(current, A, 1);
                     coordinate_t wall_right = shift(current, D, 1);
-                    visited_map[wall_left.y][wall_left.x] = true;
-                    visited_map[wall_right.y][wall_right.x] = true;
+                    mark_visited(wall_left);
+                    mark_visited(wall_right);
                 }
                 break;
             }
@@ -275,7 +303,7 @@ void add_renderable_positions(void)
             for(direction_t sub_dir = 0; sub_dir <= D; sub_dir++)
             {
                 coordinate_t new_pos = shift(current, sub_dir, 1);
-                visited_map[new_pos.y][new_pos.x] = true;
+                mark_visited(new_pos);
             }
         }
     }
@@ -302,7 +330,7 @@ void check_location(coordinate_t coordinate, linked_list *end_points)
         coordinate_t new_visit = shift(coordinate, direc, 2);
 
         if(new_visit.x < 0 || new_visit.x >= MAZE_LENGTH ||
-                new_visit.y < 0 || new_visit.y >= MAZE_HEIGHT || visited_map[new_visit.y][new_visit.x])
+                new_visit.y < 0 || new_visit.y >= MAZE_HEIGHT || was_visited(new_visit))
             continue;
 
         //Check if the connection location is on the edge.
@@ -316,7 +344,7 @@ void check_location(coordinate_t coordinate, linked_list *end_points)
             continue;
 
         found = true;
-        visited_map[new_visit.y][new_visit.x] = true;
+        mark_visited(new_visit);
         board.board_pieces[connection_loc.y][connection_loc.x] = EMPTY;
 
         //Recursively continue.
@@ -348,8 +376,8 @@ void fill_randomly(void)
 
     while(list->_size < 3)
     {
-        memset(visited_map, 0, sizeof(visited_map));
-        visited_map[origin->y][origin->x] = true;
+        bitset_fill(&visited_map, false);
+        mark_visited(*origin);
         ll_clear_free(list, true);
 
         check_location(*origin, list);
@@ -418,7 +446,7 @@ void print_board(void)
     clearscr();
 
     if(difficulty == HARD)
-        memset(visited_map, false, sizeof(visited_map));
+        bitset_fill(&visited_map, false);
 
     add_renderable_positions();
     for (int y = 0; y < MAZE_HEIGHT; ++y)
@@ -427,7 +455,7 @@ void print_board(void)
         char string[MAZE_LENGTH + 1] = {0};
         for (int x = 0; x < MAZE_LENGTH; ++x)
         {
-            string[x] = (char) (visited_map[y][x] ? board.board_pieces[y][x] : '#');
+            string[x] = (char) (bitset_test(&visited_map, y * MAZE_LENGTH + x) ? board.board_pieces[y][x] : '#');
         }
 
         println(string);
@@ -570,49 +598,52 @@ void move_hero(void)
  */
 direction_t find_dragon_movement(void)
 {
+    struct breadth_first_node {
+        //The coordinate origin.
+        coordinate_t coordinate;
+        //The direction pointing to the previous tile.
+        direction_t direction;
+        //The initial offset used.
+        direction_t initial_offset;
+        //The amount of steps we've taken in this direction.
+        int steps;
+    };
+
     //In hard mode, the dragon can path-find to the hero.
-    if(difficulty >= HARD)
+    vector_t breadth_first_queue;
+    if(difficulty >= HARD && vec_init(&breadth_first_queue, sizeof (struct breadth_first_node), 32))
     {
-        struct breadth_first_node {
-            //The coordinate origin.
-            coordinate_t coordinate;
-            //The direction pointing to the previous tile.
-            direction_t direction;
-            //The initial offset used.
-            direction_t initial_offset;
-            //The amount of steps we've taken in this direction.
-            int steps;
+        //The queue is a vector read from the front, every tile is queued at most once.
+        bool queued[MAZE_HEIGHT][MAZE_LENGTH] = {{0}};
+        struct breadth_first_node origin_node = {
+                .coordinate = board.dragon_location,
+                .steps = 0,
+                .direction = -1, //This will allow us to iterate in every direction.
+                .initial_offset = -1
         };
-        linked_list *breadth_first_queue = nl_unbounded();
-
-        struct breadth_first_node *origin_node = sys_alloc_mem(sizeof (struct breadth_first_node));
-        memset(origin_node, 0, sizeof (*origin_node));
-        origin_node->coordinate = board.dragon_location;
-        origin_node->steps = 0;
-        origin_node->direction = -1; //This will allow us to iterate in every direction.
-        origin_node->initial_offset = -1;
-        add_item(breadth_first_queue, origin_node);
-
-        //Iterate while the queue's size is > 0.
-        while(breadth_first_queue->_size > 0)
+        vec_push(&breadth_first_queue, &origin_node);
+        queued[origin_node.coordinate.y][origin_node.coordinate.x] = true;
+
+        //Iterate while the queue has unvisited nodes.
+        for (int head = 0; head < breadth_first_queue.size; ++head)
         {
-            struct breadth_first_node *node = remove_item_unsafe(breadth_first_queue, 0);
+            //Copy the node out, pushing may move the vector's memory.
+            struct breadth_first_node node = *(struct breadth_first_node *) vec_at(&breadth_first_queue, head);
             for(direction_t direction = W; direction <= D; direction++)
             {
-                if(direction == node->direction)
+                if(direction == node.direction)
                     continue;
 
                 //Shift the coordinate.
-                coordinate_t shifted = shift(node->coordinate, direction, 1);
+                coordinate_t shifted = shift(node.coordinate, direction, 1);
                 char piece = get_piece(shifted);
                 if(piece != EMPTY)
                 {
                     //Check if we've found the hero.
                     if(coordinate_eq(&board.hero_location, &shifted))
                     {
-                        int offset = node->initial_offset;
-                        sys_free_mem(node);
-                        destroy_list(breadth_first_queue, true);
+                        int offset = node.initial_offset;
+                        vec_destroy(&breadth_first_queue);
                         if(offset == -1)
                             return direction;
 
@@ -621,28 +652,24 @@ direction_t find_dragon_movement(void)
                     continue;
                 }
 
-                if(node->steps + 1 > DRAGON_SMELL_LENGTH)
+                if(node.steps + 1 > DRAGON_SMELL_LENGTH || queued[shifted.y][shifted.x])
                 {
                     continue;
                 }
 
                 //Create a new node and add it.
-                struct breadth_first_node *next_node = sys_alloc_mem(sizeof (struct breadth_first_node));
-                memset(next_node, 0, sizeof (*next_node));
-                if((int) node->initial_offset == -1)
-                    next_node->initial_offset = direction;
-                else
-                    next_node->initial_offset = node->initial_offset;
-                next_node->direction = get_opposite(direction);
-                next_node->coordinate = shifted;
-                next_node->steps = node->steps + 1;
-                add_item(breadth_first_queue, next_node);
+                struct breadth_first_node next_node = {
+                        .initial_offset = (int) node.initial_offset == -1 ? direction : node.initial_offset,
+                        .direction = get_opposite(direction),
+                        .coordinate = shifted,
+                        .steps = node.steps + 1
+                };
+                queued[shifted.y][shifted.x] = true;
+                vec_push(&breadth_first_queue, &next_node);
             }
-
-            sys_free_mem(node);
         }
 
-        destroy_list(breadth_first_queue, true);
+        vec_destroy(&breadth_first_queue);
     }
 
     //In normal mode, the dragon can see the hero in straight lines.
@@ -733,7 +760,7 @@ void start_dragonmaze_game(void)
     generate_board();
 
     //In easy mode, we don't need to worry about hiding tiles.
-    memset(visited_map, difficulty == EASY, sizeof(visited_map));
+    bitset_fill(&visited_map, difficulty == EASY);
 
     print_board();
 
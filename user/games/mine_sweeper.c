@@ -10,10 +10,12 @@
 #include "stdio.h"
 #include "print_format.h"
 #include "stdlib.h"
-#include "linked_list.h"
+#include "vector.h"
+#include "bitset.h"
 
 #define MINE_WIDTH 40
 #define MINE_HEIGHT 10
+#define MINE_SQUARES (MINE_WIDTH * MINE_HEIGHT)
 #define MINE_GENERATION_FACTOR 0.1
 
 #define HORIZ_WALL "\u2501"
@@ -24,10 +26,18 @@
 #define BL_CORNER "\u2517"
 #define BR_CORNER "\u251B"
 
+///The words backing the mine bitmap.
+static unsigned int mine_words[BITSET_WORDS(MINE_SQUARES)];
 ///The mine bitmap, 1 signifies mine, 0 signifies empty space.
-static bool mine_bitmap[MINE_WIDTH][MINE_HEIGHT];
-///The revealed map, 1 signifies a revealed square, 2 signifies a flagged square. You cannot reveal a flagged square.
-static char revealed_map[MINE_WIDTH][MINE_HEIGHT];
+static bitset_t mine_bitmap = BITSET_INIT(mine_words, MINE_SQUARES);
+///The words backing the revealed map.
+static unsigned int revealed_words[BITSET_WORDS(MINE_SQUARES)];
+///The revealed map, 1 signifies a revealed square.
+static bitset_t revealed_map = BITSET_INIT(revealed_words, MINE_SQUARES);
+///The words backing the flagged map.
+static unsigned int flagged_words[BITSET_WORDS(MINE_SQUARES)];
+///The flagged map, 1 signifies a flagged square. You cannot reveal a flagged square, and a revealed square is never flagged.
+static bitset_t flagged_map = BITSET_INIT(flagged_words, MINE_SQUARES);
 ///The total amount of free squares.
 static int free_squares;
 ///The total amount of revealed squares.
@@ -43,6 +53,17 @@ static int pc_y;
 ///If the game is currently running.
 static bool game_running;
 
+/**
+ * @brief Gets the index of the square in the game bitsets.
+ * @param x the x coordinate.
+ * @param y the y coordinate.
+ * @return the bit index.
+ */
+static inline int square_index(int x, int y)
+{
+    return x * MINE_HEIGHT + y;
+}
+
 /**
  * @brief Gets the nearby mines for the location.
  *
@@ -64,7 +85,7 @@ int get_nearby_mines(int x, int y)
             if(yNeighbor < 0 || yNeighbor >= MINE_HEIGHT)
                 continue;
 
-            if(mine_bitmap[xNeighbor][yNeighbor])
+            if(bitset_test(&mine_bitmap, square_index(xNeighbor, yNeighbor)))
                 total++;
         }
     }
@@ -83,6 +104,32 @@ int encode_coordinates(int x, int y)
     return ((x & 0xFF) << 8) | (y & 0xFF);
 }
 
+/**
+ * @brief Reveals the square, queueing it to spread further if it has no nearby mines.
+ * Flagged squares are revealed, but don't spread.
+ *
+ * @param queue the queue of encoded coordinates still to spread from.
+ * @param x the x coordinate.
+ * @param y the y coordinate.
+ */
+static void reveal_square(vector_t *queue, int x, int y)
+{
+    int square = square_index(x, y);
+    if(bitset_test(&revealed_map, square))
+        return;
+
+    bool flagged = bitset_test(&flagged_map, square);
+    bitset_clear(&flagged_map, square);
+    bitset_set(&revealed_map, square);
+    revealed_squares++;
+
+    if(!flagged && get_nearby_mines(x, y) == 0)
+    {
+        int full_word = encode_coordinates(x, y);
+        vec_push(queue, &full_word);
+    }
+}
+
 /**
  * @brief Reveals all nearby 0 spaces.
  * @authors Andrew Bowie
@@ -92,53 +139,39 @@ void reveal_all_nearby(int x, int y)
     //Don't reveal anything more if no nearby mines.
     if(get_nearby_mines(x, y) > 0)
     {
-        revealed_map[pc_x][pc_y] = 1;
+        bitset_set(&revealed_map, square_index(pc_x, pc_y));
         revealed_squares++;
         return;
     }
 
-    linked_list *node = nl_unbounded();
-    int full_word = encode_coordinates(x, y);
-
-    add_item(node,  (void *) full_word);
+    //Squares are revealed as they're queued, so each one is queued at most once.
+    vector_t queue;
+    if(!vec_init(&queue, sizeof (int), 64))
+        return;
 
-    while(list_size(node) > 0)
+    reveal_square(&queue, x, y);
+    for (int head = 0; head < queue.size; ++head)
     {
-        int item = (int) remove_item_unsafe(node, 0);
+        int item = *(int *) vec_at(&queue, head);
         int x_part = (item & 0xFF00) >> 8;
         int y_part = item & 0xFF;
 
-        if(x_part < 0 || x_part >= MINE_WIDTH || y_part < 0 || y_part >= MINE_HEIGHT)
-            continue;
-
-        //Get the nearby mines.
-        bool revealed = revealed_map[x_part][y_part] == 1;
-        int nearby_mines = get_nearby_mines(x_part, y_part);
-        if(nearby_mines == 0 && revealed_map[x_part][y_part] == 0)
+        //Add neighbors.
+        for (int xn = x_part - 1; xn <= x_part + 1; ++xn)
         {
-            //Add neighbors.
-            for (int xn = x_part - 1; xn <= x_part + 1; ++xn)
+            if(xn < 0 || xn >= MINE_WIDTH)
+                continue;
+
+            for (int yn = y_part - 1; yn <= y_part + 1; ++yn)
             {
-                if(xn < 0 || xn >= MINE_WIDTH)
+                if(yn < 0 || yn >= MINE_HEIGHT)
                     continue;
 
-                for (int yn = y_part - 1; yn <= y_part + 1; ++yn)
-                {
-                    if(yn < 0 || yn >= MINE_HEIGHT)
-                        continue;
-
-                    add_item(node, (void *) encode_coordinates(xn, yn));
-                }
+                reveal_square(&queue, xn, yn);
             }
         }
-
-        if(!revealed)
-        {
-            revealed_squares++;
-            revealed_map[x_part][y_part] = 1;
-        }
     }
-    destroy_list(node, false);
+    vec_destroy(&queue);
 }
 
 /**
@@ -167,29 +200,32 @@ void ms_game_tick(void)
             pc_x = pc_x + 1 == MINE_WIDTH ? pc_x : pc_x + 1;
             break;
         case ' ':
-            if(revealed_map[pc_x][pc_y] == 2)
+            if(bitset_test(&flagged_map, square_index(pc_x, pc_y)))
                 return;
 
-            if(mine_bitmap[pc_x][pc_y])
+            if(bitset_test(&mine_bitmap, square_index(pc_x, pc_y)))
                 game_running = false;
             else
                 reveal_all_nearby(pc_x, pc_y);
             break;
         case 'F':
         case 'f':
-            if(revealed_map[pc_x][pc_y] == 2)
+        {
+            int square = square_index(pc_x, pc_y);
+            if(bitset_test(&flagged_map, square))
             {
-                if(mine_bitmap[pc_x][pc_y])
+                if(bitset_test(&mine_bitmap, square))
                     mines_flagged--;
-                revealed_map[pc_x][pc_y] = (char) 0;
+                bitset_clear(&flagged_map, square);
             }
-            else if(revealed_map[pc_x][pc_y] == 0)
+            else if(!bitset_test(&revealed_map, square))
             {
-                if(mine_bitmap[pc_x][pc_y])
+                if(bitset_test(&mine_bitmap, square))
                     mines_flagged++;
-                revealed_map[pc_x][pc_y] = (char) 2;
+                bitset_set(&flagged_map, square);
             }
             break;
+        }
     }
 
     if(mines == mines_flagged && revealed_squares == free_squares)
@@ -216,8 +252,8 @@ void print_mine(void)
         for (int x = 0; x < MINE_WIDTH; ++x)
         {
             bool pc_pos = pc_x == x && pc_y == y;
-            bool revealed = revealed_map[x][y] == 1;
-            bool flagged = revealed_map[x][y] == 2;
+            bool revealed = bitset_test(&revealed_map, square_index(x, y));
+            bool flagged = bitset_test(&flagged_map, square_index(x, y));
             const color_t *clr = get_output_color();
 
             //Check if the player's cursor is on that position.
@@ -237,7 +273,7 @@ void print_mine(void)
             }
 
             //Is it a mine?
-            if(mine_bitmap[x][y])
+            if(bitset_test(&mine_bitmap, square_index(x, y)))
             {
                 if(revealed && !pc_pos)
                     set_output_color(get_color("red"));
@@ -298,33 +334,32 @@ void print_mine(void)
  */
 void generate_mines(unsigned long long game_seed)
 {
-    unsigned long long previous_seed = get_seed();
-
-    s_rand(game_seed);
+    //Use a stream of our own so the same seed always makes the same board.
+    rand_state_t mine_rand;
+    rand_seed(&mine_rand, game_seed);
     free_squares = MINE_WIDTH * MINE_HEIGHT;
     for (int x = 0; x < MINE_WIDTH; ++x)
     {
         for (int y = 0; y < MINE_HEIGHT; ++y)
         {
             //Generate random number for mine generation.
-            double factor = next_random_lim(100) / 100.0;
+            double factor = rand_next_lim(&mine_rand, 100) / 100.0;
             if(factor < MINE_GENERATION_FACTOR)
             {
-                mine_bitmap[x][y] = true;
+                bitset_set(&mine_bitmap, square_index(x, y));
                 mines++;
                 free_squares--;
             }
         }
     }
-
-    s_rand(previous_seed);
 }
 
 void start_minesweeper_game(unsigned long long game_seed)
 {
     //Clear out memory for the maps.
-    memset(mine_bitmap, 0, sizeof (mine_bitmap));
-    memset(revealed_map, 0, sizeof (revealed_map));
+    bitset_fill(&mine_bitmap, false);
+    bitset_fill(&revealed_map, false);
+    bitset_fill(&flagged_map, false);
     game_running = true;
     //Reset some flags.
     pc_x = pc_y = mines = mines_flagged = free_squares = revealed_squares = 0;
@@ -335,7 +370,8 @@ void start_minesweeper_game(unsigned long long game_seed)
         ms_game_tick();
         print_mine();
     }
-    memset(revealed_map, 1, sizeof (revealed_map));
+    bitset_fill(&revealed_map, true);
+    bitset_fill(&flagged_map, false);
     pc_x = pc_y = -1;
     print_mine();
 
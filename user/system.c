@@ -8,6 +8,7 @@
 #include <string.h>
 
 #include <mpx/serial.h>
+#include <mpx/sys_call.h>
 #include <mpx/vm.h>
 
 #include <memory.h>
@@ -39,6 +40,8 @@ int sys_req(op_code op, ...)
 	char *buffer = NULL;
 	size_t len = 0;
 
+	unsigned int ebx = 0, ecx = 0;
+
 	if (op == READ || op == WRITE) {
 		va_list ap;
 		va_start(ap, op);
@@ -46,10 +49,22 @@ int sys_req(op_code op, ...)
 		buffer = va_arg(ap, char *);
 		len = va_arg(ap, size_t);
 		va_end(ap);
+		ebx = (unsigned int) dev;
+		ecx = (unsigned int) buffer;
+	} else if (op == SLEEP || op == SLEEP_UNTIL) {
+		/* The 64-bit tick doesn't fit in one register, so its high half goes in ECX. */
+		va_list ap;
+		va_start(ap, op);
+		unsigned long long arg = (op == SLEEP)
+			? va_arg(ap, unsigned int)
+			: va_arg(ap, unsigned long long);
+		va_end(ap);
+		ebx = (unsigned int) arg;
+		ecx = (unsigned int) (arg >> 32);
 	}
 
 	int ret = 0;
-	__asm__ volatile("int $0x60" : "=a"(ret) : "a"(op), "b"(dev), "c"(buffer), "d"(len));
+	__asm__ volatile("int $0x60" : "=a"(ret) : "a"(op), "b"(ebx), "c"(ecx), "d"(len));
 
 	if (ret == -1 && (op == READ || op == WRITE)) {
 		return (op == READ)
@@ -93,6 +108,8 @@ void sys_idle_process(void)
 	for (;;) {
 //		sys_req(WRITE, COM1, msg, sizeof(msg));
 		sys_req(IDLE);
+		/* Nothing else wants to run, so sleep until an interrupt brings work. */
+		cpu_idle();
 	}
 }
 